@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board.h"
+#include "movegen.h"
+#include "solver.h"
+
+// Timed runs of every benchmark, unless given on the command line
+#define BENCH_REPETITIONS 100
+
+// Untimed runs before the timed ones, so caches and lazily built tables are warm
+#define BENCH_WARMUP 5
+
+// Runs of the quick functions that are timed together as one sample,
+// so the clock itself doesn't dominate the sample
+#define BENCH_BATCH 1000
+
+/**
+ * Every heap allocation of the program goes through here and is counted
+ */
+static std::atomic<std::uint64_t> heap_allocations(0);
+
+static void* countedAllocation(std::size_t bytes) noexcept {
+    ++heap_allocations;
+    return std::malloc(bytes ? bytes : 1);
+}
+
+/**
+ * Gives memory back to malloc. It is never inlined into a delete, where the
+ * compiler would see memory from new going to free and warn about it.
+ */
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static void release(void* memory) noexcept { std::free(memory); }
+
+// Every form of new and delete is replaced, so the count doesn't depend on which ones the library calls
+void* operator new(std::size_t bytes) {
+    if (void* memory = countedAllocation(bytes)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t bytes) {
+    if (void* memory = countedAllocation(bytes)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept { return countedAllocation(bytes); }
+void* operator new[](std::size_t bytes, const std::nothrow_t&) noexcept { return countedAllocation(bytes); }
+
+void operator delete(void* memory) noexcept { release(memory); }
+void operator delete[](void* memory) noexcept { release(memory); }
+void operator delete(void* memory, std::size_t) noexcept { release(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { release(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { release(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { release(memory); }
+
+/**
+ * A position from the corpus along with its best move
+ */
+typedef struct Position {
+    Board board;
+    std::string rack;
+    Move best;
+    int tiles;
+} position;
+
+/**
+ * Times a function
+ * @param warmup
+ *          Runs that are not timed
+ * @param repetitions
+ *          Number of samples
+ * @param batch
+ *          Runs that make up one sample
+ * @param fn
+ *          Function to time
+ * @return Nanoseconds per run of every sample
+ */
+template <typename F>
+std::vector<double> measure(int warmup, int repetitions, int batch, F fn) {
+    for (int run = 0; run < warmup; ++run) fn();
+
+    std::vector<double> samples;
+    samples.reserve(repetitions);
+    for (int rep = 0; rep < repetitions; ++rep) {
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < batch; ++run) fn();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        samples.push_back((double) elapsed.count() / batch);
+    }
+    return samples;
+}
+
+/**
+ * Sample at the given percentile (nearest rank) of sorted samples
+ */
+double percentile(const std::vector<double>& sorted, double pct) {
+    std::size_t rank = (std::size_t) (pct / 100.0 * sorted.size() + 0.5);
+    return sorted[std::min(sorted.size() - 1, rank ? rank - 1 : 0)];
+}
+
+/**
+ * Writes the statistics of a benchmark as one JSON object per line
+ */
+void report(const std::string& name, const std::string& position, std::vector<double> samples) {
+    if (samples.empty()) return;
+    std::sort(samples.begin(), samples.end());
+
+    double total = 0;
+    for (double sample : samples) total += sample;
+
+    std::cout << "{\"benchmark\":\"" << name << "\",\"position\":\"" << position << "\""
+              << ",\"samples\":" << samples.size()
+              << ",\"mean_ns\":" << total / samples.size()
+              << ",\"min_ns\":" << samples.front()
+              << ",\"p50_ns\":" << percentile(samples, 50)
+              << ",\"p90_ns\":" << percentile(samples, 90)
+              << ",\"p99_ns\":" << percentile(samples, 99)
+              << ",\"max_ns\":" << samples.back() << "}\n";
+}
+
+/**
+ * Heap allocations made by a function, after it has run once
+ * so anything built on first use isn't counted
+ */
+template <typename F>
+std::uint64_t allocations(F fn) {
+    fn();
+    std::uint64_t before = heap_allocations;
+    fn();
+    return heap_allocations - before;
+}
+
+/**
+ * Writes the heap allocations of a query as one JSON object per line
+ */
+void reportAllocations(const std::string& position, std::uint64_t candidates, std::uint64_t generate, std::uint64_t query) {
+    std::cout << "{\"benchmark\":\"allocations\",\"position\":\"" << position << "\""
+              << ",\"candidates\":" << candidates
+              << ",\"generate_allocations\":" << generate
+              << ",\"per_candidate\":" << (candidates ? (double) generate / candidates : 0.0)
+              << ",\"findBestWord_allocations\":" << query << "}\n";
+}
+
+/**
+ * Times each step of a query separately for every position in the corpus:
+ * benchmark CORPUS [REPETITIONS] [THREADS]
+ * The results are written as JSON lines, the first one describes the build.
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cout << "Usage: benchmark CORPUS [REPETITIONS] [THREADS]\n";
+        return EXIT_FAILURE;
+    }
+    int repetitions = (argc >= 3) ? std::atoi(argv[2]) : BENCH_REPETITIONS;
+    std::size_t threads = (argc >= 4) ? std::strtoul(argv[3], nullptr, 10) : SOLVER_THREADS;
+    if (repetitions <= 0) repetitions = BENCH_REPETITIONS;
+
+    std::ifstream corpus(argv[1]);
+    if (!corpus.is_open()) { std::cout << "File name not found\n"; return EXIT_FAILURE; }
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    Solver solver(threads);
+    if (!solver.isLoaded()) { std::cout << "Dictionary not found\n"; return EXIT_FAILURE; }
+
+    std::vector<Position> positions;
+    Position pos;
+    while (readPosition(corpus, pos.board, pos.rack)) {
+        computeCrossChecks(pos.board, solver.gaddag());
+        pos.tiles = pos.board.occupied.count();
+        Board scratch = pos.board;
+        pos.best = solver.findBestWord(scratch, pos.rack);
+        positions.push_back(pos);
+    }
+
+    std::cout << "{\"benchmark\":\"config\",\"method\":\""
+              << (METHOD == PROBABILISTIC ? "PROBABILISTIC" : "BRUTE_FORCE") << "\""
+              << ",\"bonus_tiles\":" << BONUS_TILES
+              << ",\"threads\":" << solver.threads()
+              << ",\"repetitions\":" << repetitions
+              << ",\"warmup\":" << BENCH_WARMUP
+              << ",\"positions\":" << positions.size() << "}\n";
+
+    /**
+     * Loading the dictionary, from the compiled image and from the text file
+     */
+    report("load_image", "-", measure(1, std::min(repetitions, 20), 1, []() {
+        Solver loaded(DICTIONARY_IMAGE, "", 1);
+    }));
+    report("load_text", "-", measure(0, 3, 1, []() {
+        Solver loaded("", DICTIONARY, 1);
+    }));
+
+    /**
+     * Every step of a query on every position, and over all positions
+     */
+    std::vector<double> all_words, all_generate, all_score, all_possible, all_best;
+    std::uint64_t all_candidates = 0, all_generate_allocations = 0, all_query_allocations = 0;
+    for (std::size_t idx = 0; idx < positions.size(); ++idx) {
+        Position& p = positions[idx];
+        std::string name = "p" + std::to_string(idx) + "-" + std::to_string(p.tiles) + "-" + p.rack;
+        std::vector<double> samples;
+
+        samples = measure(BENCH_WARMUP, repetitions, 1, [&]() { solver.getPossibleWords(p.rack); });
+        report("getPossibleWords", name, samples);
+        all_words.insert(all_words.end(), samples.begin(), samples.end());
+
+        MoveGenerator generator(solver.gaddag());
+        samples = measure(BENCH_WARMUP, repetitions, 1, [&]() {
+            generator.generate(p.board, p.rack, [](const Move&) {});
+        });
+        report("generateMoves", name, samples);
+        all_generate.insert(all_generate.end(), samples.begin(), samples.end());
+
+        if (!p.best.word.empty()) {
+            samples = measure(BENCH_WARMUP, repetitions, BENCH_BATCH, [&]() {
+                Move m = p.best;
+                getPointValueOfMove(m);
+            });
+            report("getPointValueOfMove", name, samples);
+            all_score.insert(all_score.end(), samples.begin(), samples.end());
+
+            #if (METHOD == PROBABILISTIC)
+                samples = measure(BENCH_WARMUP, repetitions, BENCH_BATCH, [&]() {
+                    Move m = p.best;
+                    isPossibleMove(p.board, m);
+                });
+                report("isPossibleMove", name, samples);
+                all_possible.insert(all_possible.end(), samples.begin(), samples.end());
+            #endif
+        }
+
+        // Every query starts from the same board, the copy isn't timed
+        std::vector<Board> boards(BENCH_WARMUP + repetitions, p.board);
+        std::size_t next = 0;
+        samples = measure(BENCH_WARMUP, repetitions, 1, [&]() { solver.findBestWord(boards[next++], p.rack); });
+        report("findBestWord", name, samples);
+        all_best.insert(all_best.end(), samples.begin(), samples.end());
+
+        // Moves are counted while allocations are, so the callback must not allocate either
+        std::uint64_t candidates = 0;
+        std::uint64_t generate = allocations([&]() {
+            candidates = 0;
+            generator.generate(p.board, p.rack, [&candidates](const Move&) { ++candidates; });
+        });
+        Board query_board = p.board;
+        std::uint64_t query = allocations([&]() { solver.findBestWord(query_board, p.rack); });
+        reportAllocations(name, candidates, generate, query);
+        all_candidates += candidates;
+        all_generate_allocations += generate;
+        all_query_allocations += query;
+    }
+
+    /**
+     * Scoring a word at every place on the board, most of which have no bonus
+     */
+    std::vector<Move> places;
+    for (int direction = VERTICAL; direction <= HORIZONTAL; ++direction) {
+        for (int y = 0; y < BOARD_SIZE; ++y) {
+            for (int x = 0; x + 7 <= BOARD_SIZE; ++x) {
+                Move m;
+                m.word = "CARDIAE";
+                m.direction = direction;
+                m.anchorX = (direction == HORIZONTAL) ? x : y;
+                m.anchorY = (direction == HORIZONTAL) ? y : x;
+                places.push_back(m);
+            }
+        }
+    }
+    std::size_t place = 0;
+    report("getPointValueOfMove", "every-place", measure(BENCH_WARMUP, repetitions, BENCH_BATCH, [&]() {
+        getPointValueOfMove(places[place++ % places.size()]);
+    }));
+
+    /**
+     * Every query of the corpus with more and more threads
+     */
+    std::size_t cores = std::max(4u, std::thread::hardware_concurrency());
+    for (std::size_t count = 1; count <= cores; count <<= 1) {
+        Solver threaded(count);
+        std::vector<double> scaling;
+        for (Position& p : positions) {
+            std::vector<Board> boards(BENCH_WARMUP + repetitions, p.board);
+            std::size_t next = 0;
+            std::vector<double> samples = measure(BENCH_WARMUP, repetitions, 1, [&]() {
+                threaded.findBestWord(boards[next++], p.rack);
+            });
+            scaling.insert(scaling.end(), samples.begin(), samples.end());
+        }
+        report("findBestWord_threads", std::to_string(count), scaling);
+    }
+
+    report("getPossibleWords", "all", all_words);
+    report("generateMoves", "all", all_generate);
+    report("getPointValueOfMove", "all", all_score);
+    report("isPossibleMove", "all", all_possible);
+    report("findBestWord", "all", all_best);
+    reportAllocations("all", all_candidates, all_generate_allocations, all_query_allocations);
+
+    return EXIT_SUCCESS;
+}
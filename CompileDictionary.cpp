@@ -0,0 +1,28 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "gaddag.h"
+
+/**
+ * Compiles the text dictionary into a binary GADDAG image
+ * that the solver memory-maps at startup.
+ * Usage: compile_dictionary <dictionary.txt> <image>
+ */
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <dictionary.txt> <image>\n";
+        return EXIT_FAILURE;
+    }
+
+    auto timer_start = std::chrono::steady_clock::now();
+    Gaddag gaddag;
+    if (!gaddag.load(argv[1])) return EXIT_FAILURE;
+    if (!gaddag.save(argv[2])) return EXIT_FAILURE;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timer_start;
+
+    std::cout << "Compiled " << gaddag.wordCount() << " words into " << gaddag.nodeCount() << " nodes and "
+              << gaddag.edgeCount() << " edges in " << elapsed.count() << "s\n";
+    return EXIT_SUCCESS;
+}
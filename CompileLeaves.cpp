@@ -0,0 +1,30 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "leaves.h"
+
+/**
+ * Compiles the leave table into a binary image that the solver
+ * memory-maps at startup. Every leave starts at a rough estimate,
+ * and the values in the text file (one "LEAVE VALUE" per line),
+ * if one is given, replace the estimates of the leaves it lists.
+ * Usage: compile_leaves [leaves.txt] <image>
+ */
+int main(int argc, char* argv[]) {
+    if (argc != 2 && argc != 3) {
+        std::cout << "Usage: " << argv[0] << " [leaves.txt] <image>\n";
+        return EXIT_FAILURE;
+    }
+
+    auto timer_start = std::chrono::steady_clock::now();
+    LeaveTable leaves;
+    leaves.estimate();
+    if (argc == 3 && !leaves.load(argv[1])) return EXIT_FAILURE;
+    if (!leaves.save(argv[argc - 1])) return EXIT_FAILURE;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - timer_start;
+
+    std::cout << "Compiled " << LeaveTable::size() << " leaves in " << elapsed.count() << "s\n";
+    return EXIT_SUCCESS;
+}
@@ -1,25 +1,283 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "board.h"
+#include "endgame.h"
+#include "game.h"
+#include "server.h"
+#include "simulate.h"
+#include "solver.h"
+#include "threadpool.h"
+
+// Number of positions read and solved together in batch mode
+#define BATCH_CHUNK 1024
+
+// Number of games played together in self-play mode, their positions are kept until all are done
+#define SELFPLAY_CHUNK 256
+
+/**
+ * A board and the letters in the hands of the user
+ */
+typedef struct Position {
+	Board board;
+	std::string rack;
+} position;
+
+/**
+ * Solves every position in the input and writes one line per position,
+ * in the same order. Positions are read in chunks and the positions of
+ * a chunk are spread over the worker threads, which all share one solver
+ * and its result cache, so a position that comes up again isn't searched again.
+ * @param stats
+ *          What every query did, added up
+ * @return Number of positions solved
+ */
+std::size_t solveBatch(std::istream& input, std::ostream& output, std::size_t threads, QueryStats& stats) {
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+
+	// Every position is searched on one thread, the threads work on different positions
+	Solver solver(1);
+	solver.enableCache(CACHE_BYTES);
+	ThreadPool pool(threads);
+
+	std::vector<Position> positions(BATCH_CHUNK);
+	std::vector<Move> results(BATCH_CHUNK);
+	std::vector<QueryStats> counted(BATCH_CHUNK);
+	std::size_t solved = 0;
+
+	for (;;) {
+		std::size_t count = 0;
+		while (count < BATCH_CHUNK && readPosition(input, positions[count].board, positions[count].rack)) ++count;
+		if (count == 0) break;
+
+		pool.run(count, [&](std::size_t task, std::size_t) {
+			counted[task] = QueryStats();
+			results[task] = solver.findBestWord(positions[task].board, positions[task].rack, &counted[task]);
+		});
+
+		for (std::size_t idx = 0; idx < count; ++idx) {
+			writeMove(output, results[idx]);
+			stats.add(counted[idx]);
+		}
+		solved += count;
+		if (count < BATCH_CHUNK) break;
+	}
+	output.flush();
+
+	CacheStats cache = solver.cacheStats();
+	std::cerr << cache.hits << " cache hits, " << cache.misses << " misses, " << cache.evictions << " evictions\n";
+	return solved;
+}
+
+/**
+ * Plays games against itself, spread over the worker threads, and writes
+ * one line per game in order: both scores and the number of turns.
+ * Game n draws its tiles with seed n, so the games don't depend on the
+ * number of threads.
+ * @param positions
+ *          If not null, every position of every game is written to it
+ * @return Results of all the games added up, the scores are totals
+ */
+GameResult selfPlay(std::size_t games, std::size_t threads, std::ostream& output, std::ostream* positions) {
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+
+	// Every game is played on one thread, the threads play different games
+	Solver solver(1);
+	ThreadPool pool(threads);
+
+	std::vector<GameResult> results(SELFPLAY_CHUNK);
+	std::vector<std::ostringstream> recorded(positions ? SELFPLAY_CHUNK : 0);
+	GameResult total;
+
+	for (std::size_t first = 0; first < games; first += SELFPLAY_CHUNK) {
+		std::size_t count = std::min<std::size_t>(SELFPLAY_CHUNK, games - first);
+		pool.run(count, [&](std::size_t task, std::size_t) {
+			if (positions) recorded[task].str("");
+			results[task] = playGame(solver, first + task, positions ? &recorded[task] : nullptr);
+		});
+
+		for (std::size_t idx = 0; idx < count; ++idx) {
+			const GameResult& r = results[idx];
+			output << r.scores[0] << ' ' << r.scores[1] << ' ' << r.turns << '\n';
+			if (positions) *positions << recorded[idx].str();
+			total.scores[0] += r.scores[0];
+			total.scores[1] += r.scores[1];
+			total.turns += r.turns;
+			total.bingos += r.bingos;
+		}
+	}
+	output.flush();
+	return total;
+}
 
 int main(int argc, char* argv[]) {
+
+	/**
+	 * Batch mode: scrabble -b [FILE] [THREADS]
+	 * Positions come from the file, or stdin if there is no file or it is "-"
+	 */
+	if (argc >= 2 && std::string(argv[1]) == "-b") {
+		if (argc > 4) { std::cout << "Incorrect number of inputs/Unknown Flag\n"; return EXIT_FAILURE; }
+		std::size_t threads = (argc == 4) ? std::strtoul(argv[3], nullptr, 10) : 0;
+
+		std::ifstream _file;
+		if (argc >= 3 && std::string(argv[2]) != "-") {
+			_file.open(argv[2]);
+			if (!_file.is_open()) { std::cout << "File name not found\n"; return EXIT_FAILURE; }
+		}
+		std::istream& input = _file.is_open() ? _file : std::cin;
+
+		auto start = std::chrono::steady_clock::now();
+		QueryStats stats;
+		std::size_t solved = solveBatch(input, std::cout, threads, stats);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cerr << solved << " positions in " << seconds << " s ("
+			<< (seconds > 0 ? solved / seconds : 0) << " positions/s)\n";
+		STATS(std::cerr << stats.words << " words, " << stats.placements << " placements, "
+			<< stats.rejected << " cross-check rejections, " << stats.lookups << " lookups, "
+			<< stats.pruned << " pruned\n");
+		return EXIT_SUCCESS;
+	}
+
+	/**
+	 * Daemon mode: scrabble -d [SOCKET] [THREADS]
+	 * Loads the dictionary once and answers one position per line, on the
+	 * Unix domain socket or on stdin and stdout if there is no socket or it is "-"
+	 */
+	if (argc >= 2 && std::string(argv[1]) == "-d") {
+		if (argc > 4) { std::cout << "Incorrect number of inputs/Unknown Flag\n"; return EXIT_FAILURE; }
+		std::size_t threads = (argc == 4) ? std::strtoul(argv[3], nullptr, 10) : SOLVER_THREADS;
+
+		Solver solver(threads);
+		if (!solver.isLoaded()) { std::cerr << "Dictionary not found\n"; return EXIT_FAILURE; }
+		solver.enableCache(CACHE_BYTES);
+
+		if (argc >= 3 && std::string(argv[2]) != "-") {
+			std::cerr << "Listening on " << argv[2] << '\n';
+			return serveSocket(solver, argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+		serveStream(solver, std::cin, std::cout);
+		return EXIT_SUCCESS;
+	}
+
+	/**
+	 * Simulation mode: scrabble -s [FILE] [CANDIDATES] [MILLISECONDS]
+	 * Simulates the best candidate moves of the first position in the file
+	 * (or stdin if there is no file or it is "-") and writes one line per
+	 * candidate: the move, its mean equity, the confidence interval and the
+	 * number of games, best first
+	 */
+	if (argc >= 2 && std::string(argv[1]) == "-s") {
+		if (argc > 5) { std::cout << "Incorrect number of inputs/Unknown Flag\n"; return EXIT_FAILURE; }
+		SimOptions options;
+		if (argc >= 4) options.candidates = std::strtoul(argv[3], nullptr, 10);
+		if (argc == 5) options.milliseconds = std::strtoul(argv[4], nullptr, 10);
+
+		std::ifstream _file;
+		if (argc >= 3 && std::string(argv[2]) != "-") {
+			_file.open(argv[2]);
+			if (!_file.is_open()) { std::cout << "File name not found\n"; return EXIT_FAILURE; }
+		}
+		std::istream& input = _file.is_open() ? _file : std::cin;
+
+		Position pos;
+		if (!readPosition(input, pos.board, pos.rack)) { std::cout << "No position found\n"; return EXIT_FAILURE; }
+
+		Solver solver(1);
+		Simulator simulator(solver);
+		std::vector<Candidate> candidates = simulator.simulate(pos.board, pos.rack, options);
+		for (const Candidate& c : candidates) {
+			std::cout << c.move.word << ' ' << c.move.anchorX << ' ' << c.move.anchorY << ' '
+				<< (c.move.direction == VERTICAL ? "DOWN" : "RIGHT") << ' ' << c.move.points << ' '
+				<< c.mean << ' ' << c.low << ' ' << c.high << ' ' << c.iterations << (c.dropped ? " dropped\n" : "\n");
+		}
+		return EXIT_SUCCESS;
+	}
+
+	/**
+	 * Endgame mode: scrabble -e [FILE] [MILLISECONDS] [OPPONENT]
+	 * Searches the first position in the file (or stdin if there is no file or it
+	 * is "-") as an endgame. The opponent's rack is every tile that isn't on the
+	 * board or the rack, unless it is given. Writes the spread, the depth and the
+	 * speed of the search, then the best line one move per line ('-' for a pass)
+	 */
+	if (argc >= 2 && std::string(argv[1]) == "-e") {
+		if (argc > 5) { std::cout << "Incorrect number of inputs/Unknown Flag\n"; return EXIT_FAILURE; }
+		std::size_t milliseconds = (argc >= 4) ? std::strtoul(argv[3], nullptr, 10) : ENDGAME_MILLISECONDS;
+
+		std::ifstream _file;
+		if (argc >= 3 && std::string(argv[2]) != "-") {
+			_file.open(argv[2]);
+			if (!_file.is_open()) { std::cout << "File name not found\n"; return EXIT_FAILURE; }
+		}
+		std::istream& input = _file.is_open() ? _file : std::cin;
+
+		Position pos;
+		if (!readPosition(input, pos.board, pos.rack)) { std::cout << "No position found\n"; return EXIT_FAILURE; }
+		std::string opponent = (argc == 5) ? std::string(argv[4]) : unseenTiles(pos.board, pos.rack);
+		if (opponent.size() > RACK_SIZE) { std::cout << "The bag isn't empty, give the opponent's rack\n"; return EXIT_FAILURE; }
+
+		Solver solver(1);
+		EndgameSolver endgame(solver);
+		EndgameResult result = endgame.solve(pos.board, pos.rack, opponent, milliseconds);
+
+		std::cout << "spread " << result.spread << " depth " << result.depth << (result.solved ? " solved" : "")
+			<< " nodes " << result.nodes << " (" << (result.seconds > 0 ? result.nodes / result.seconds : 0) << " nodes/s)\n";
+		for (const Move& m : result.line) writeMove(std::cout, m);
+		return EXIT_SUCCESS;
+	}
+
+	/**
+	 * Self-play mode: scrabble -p GAMES [THREADS] [POSITIONS]
+	 * Plays the games and writes their results, the positions of every
+	 * game go to the POSITIONS file if there is one
+	 */
+	if (argc >= 2 && std::string(argv[1]) == "-p") {
+		if (argc < 3 || argc > 5) { std::cout << "Incorrect number of inputs/Unknown Flag\n"; return EXIT_FAILURE; }
+		std::size_t games = std::strtoul(argv[2], nullptr, 10);
+		std::size_t threads = (argc >= 4) ? std::strtoul(argv[3], nullptr, 10) : 0;
+
+		std::ofstream _file;
+		if (argc == 5) {
+			_file.open(argv[4]);
+			if (!_file.is_open()) { std::cout << "Unable to write positions\n"; return EXIT_FAILURE; }
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		GameResult total = selfPlay(games, threads, std::cout, _file.is_open() ? &_file : nullptr);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (games) {
+			std::cerr << games << " games in " << seconds << " s (" << (seconds > 0 ? games / seconds : 0) << " games/s, "
+				<< (seconds > 0 ? total.turns / seconds : 0) << " moves/s), mean scores "
+				<< (double) total.scores[0] / games << " and " << (double) total.scores[1] / games << ", "
+				<< (double) total.bingos / games << " bingos per game\n";
+		}
+		return EXIT_SUCCESS;
+	}
+
+	/**
+	 * Word mode: scrabble [-f] LETTERS
+	 * Lists the words that can be made from the letters (-f for four or more letters)
+	 */
 	std::string _input;
-	std::vector<char> _letters;
 	bool _four_or_more = false;
 
-	if ((argc == 3 && std::string(argv[1]) != "-f") || argc > 3) { 
+	if (argc < 2 || (argc == 3 && std::string(argv[1]) != "-f") || argc > 3) {
 		std::cout << "Incorrect number of inputs/Unknown Flag\n"; return EXIT_FAILURE; }
 	else if (argc == 3) { _four_or_more = true; _input = argv[2]; }
 	else { _input = argv[1]; }
-	for (char c : _input) { _letters.push_back(c); }
-
-	std::vector<std::string> _possible_words = getPossibleWords(_letters, _four_or_more);
+	for (char& c : _input) c = std::toupper(c);
 
-	Board b = createBoardFromFile("tests/test.txt");
+	Solver solver(1);
+	std::vector<std::string> _possible_words = solver.getPossibleWords(_input, _four_or_more ? 4 : 2);
+	for (const std::string& word : _possible_words) std::cout << word << '\n';
 
 	return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
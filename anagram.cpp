@@ -0,0 +1,91 @@
+#include "anagram.h"
+
+#include <algorithm>
+
+/**
+ * Groups the words by signature. The words are sorted by signature
+ * and then alphabetically so every group is in alphabetical order.
+ */
+void AnagramIndex::build(const std::vector<std::string>& words) {
+    std::vector<std::pair<std::string, std::string> > keyed;
+    keyed.reserve(words.size());
+    for (const std::string& word : words)
+        keyed.push_back(std::make_pair(signature(word), word));
+    std::sort(keyed.begin(), keyed.end());
+
+    _words.clear();
+    _words.reserve(keyed.size());
+    _groups.clear();
+    _groups.reserve(keyed.size());
+
+    for (std::size_t idx = 0; idx < keyed.size(); ++idx) {
+        if (idx == 0 || keyed[idx].first != keyed[idx - 1].first)
+            _groups[keyed[idx].first] = std::make_pair((std::uint32_t) idx, (std::uint32_t) idx);
+        _groups[keyed[idx].first].second = (std::uint32_t) idx + 1;
+        _words.push_back(keyed[idx].second);
+    }
+}
+
+std::string AnagramIndex::signature(std::string word) {
+    for (char& c : word) c = (char) std::toupper(c);
+    std::sort(word.begin(), word.end());
+    return word;
+}
+
+std::vector<std::string> AnagramIndex::anagrams(const std::string& letters) const {
+    std::vector<std::string> result;
+    auto group = _groups.find(signature(letters));
+    if (group != _groups.end())
+        result.assign(_words.begin() + group->second.first, _words.begin() + group->second.second);
+    return result;
+}
+
+/**
+ * Looks up every distinct subset of the letters. Duplicate letters are
+ * handled by choosing how many copies of each letter to use, so no
+ * subset is looked up twice.
+ */
+std::vector<std::string> AnagramIndex::subanagrams(const std::string& letters) const {
+    std::vector<std::string> result;
+    std::string subset;
+    auto found = [&result](std::vector<std::string>::const_iterator first, std::vector<std::string>::const_iterator last) {
+        result.insert(result.end(), first, last);
+    };
+    collect(signature(letters), 0, subset, found);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void AnagramIndex::subanagrams(const std::string& letters, ScratchList<const std::string*>& result) const {
+    std::string subset;
+    auto found = [&result](std::vector<std::string>::const_iterator first, std::vector<std::string>::const_iterator last) {
+        for (; first != last; ++first) result.push_back(&*first);
+    };
+    collect(signature(letters), 0, subset, found);
+    std::sort(result.begin(), result.end(), [](const std::string* a, const std::string* b) { return *a < *b; });
+}
+
+/**
+ * Chooses how many copies of the letter at idx go into the subset
+ * and moves on to the next distinct letter. Every group of words
+ * found is handed over as a range of the index.
+ */
+template <typename F>
+void AnagramIndex::collect(const std::string& letters, std::size_t idx, std::string& subset, F& found) const {
+    if (idx == letters.length()) {
+        auto group = _groups.find(subset);
+        if (group != _groups.end())
+            found(_words.begin() + group->second.first, _words.begin() + group->second.second);
+        return;
+    }
+
+    std::size_t end = idx;
+    while (end < letters.length() && letters[end] == letters[idx]) ++end;
+
+    std::size_t length = subset.length();
+    for (std::size_t copies = 0; copies <= end - idx; ++copies) {
+        collect(letters, end, subset, found);
+        subset += letters[idx];
+    }
+    subset.resize(length);
+}
@@ -0,0 +1,79 @@
+#ifndef ANAGRAM_H
+#define ANAGRAM_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "arena.h"
+
+/**
+ * Index of the dictionary keyed by the sorted letters of each word
+ * (its signature), e.g. "ABDE" for BEAD, BADE and ABED.
+ *
+ * The words that can be made from a set of letters are found by
+ * looking up the signature of every distinct subset of those letters,
+ * so only words that can actually be made are ever touched. A rack of
+ * 8 letters has at most 256 subsets no matter how big the dictionary is.
+ */
+class AnagramIndex {
+public:
+    AnagramIndex() {};
+    explicit AnagramIndex(const std::vector<std::string>& words) { build(words); }
+
+    /**
+     * Builds the index from a list of uppercase words
+     */
+    void build(const std::vector<std::string>& words);
+
+    /**
+     * Sorted letters of a word
+     */
+    static std::string signature(std::string word);
+
+    /**
+     * Retrieves the words made of exactly the given letters
+     * @param letters
+     *          Letters that every word must use
+     * @return Words that use all of the letters, in alphabetical order
+     */
+    std::vector<std::string> anagrams(const std::string& letters) const;
+
+    /**
+     * Retrieves all possible words given the combination of letters
+     * @param letters
+     *          Letters that can be used to make the words
+     * @return Words that use some or all of the letters, in alphabetical order
+     */
+    std::vector<std::string> subanagrams(const std::string& letters) const;
+
+    /**
+     * Retrieves all possible words without copying them, for searches
+     * that run for every query
+     * @param letters
+     *          Letters that can be used to make the words
+     * @param result
+     *          Filled with the words in the index, in alphabetical order
+     */
+    void subanagrams(const std::string& letters, ScratchList<const std::string*>& result) const;
+
+    /**
+     * Number of words and distinct signatures in the index
+     */
+    std::size_t wordCount() const { return _words.size(); }
+    std::size_t signatureCount() const { return _groups.size(); }
+
+private:
+    template <typename F>
+    void collect(const std::string& letters, std::size_t idx, std::string& subset, F& found) const;
+
+    // Words ordered by signature so each signature is one contiguous range
+    std::vector<std::string> _words;
+
+    // Signature -> range [first, second) in the words
+    std::unordered_map<std::string, std::pair<std::uint32_t, std::uint32_t> > _groups;
+};
+
+#endif /* ANAGRAM_H */
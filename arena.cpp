@@ -0,0 +1,85 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstring>
+
+Arena::Arena(std::size_t bytes) : _current(0), _offset(0), _used(0), _last(nullptr) {
+    _blocks.push_back(Block{std::unique_ptr<char[]>(new char[bytes]), bytes, 0});
+}
+
+/**
+ * Takes the space from the current block, or from a new block
+ * at least twice as big as the last one when it doesn't fit
+ */
+void* Arena::allocateBytes(std::size_t bytes, std::size_t alignment) {
+    Block* current = &_blocks[_current];
+    std::uintptr_t base = (std::uintptr_t) current->memory.get();
+    std::size_t start = ((base + _offset + alignment - 1) & ~(std::uintptr_t) (alignment - 1)) - base;
+
+    if (start + bytes > current->size) {
+        // A block left over from an earlier query is only kept if the space fits
+        if (_current + 1 < _blocks.size() && _blocks[_current + 1].size < bytes + alignment)
+            _blocks.resize(_current + 1);
+        if (_current + 1 == _blocks.size()) {
+            std::size_t size = std::max(current->size << 1, bytes + alignment);
+            _blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size, 0});
+        }
+        ++_current;
+        current = &_blocks[_current];
+        current->start = _used;
+        _offset = 0;
+        base = (std::uintptr_t) current->memory.get();
+        start = ((base + alignment - 1) & ~(std::uintptr_t) (alignment - 1)) - base;
+    }
+
+    _used += start + bytes - _offset;
+    _offset = start + bytes;
+    _last = current->memory.get() + start;
+    return _last;
+}
+
+void* Arena::growBytes(void* data, std::size_t bytes, std::size_t new_bytes, std::size_t alignment) {
+    char* old = static_cast<char*>(data);
+    Block& current = _blocks[_current];
+
+    // The last allocation only has to move the end of the block
+    if (data == _last && old + new_bytes <= current.memory.get() + current.size) {
+        _used += new_bytes - bytes;
+        _offset += new_bytes - bytes;
+        return data;
+    }
+
+    void* moved = allocateBytes(new_bytes, alignment);
+    if (bytes) std::memcpy(moved, old, bytes);
+    return moved;
+}
+
+/**
+ * Finds the block the mark falls in. An empty arena that outgrew
+ * its first block swaps all of its blocks for a single one.
+ */
+void Arena::rewind(Mark mark) {
+    if (mark >= _used) return;
+
+    if (mark == 0 && _blocks.size() > 1) {
+        std::size_t size = capacity();
+        _blocks.clear();
+        _blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size, 0});
+    }
+
+    while (_current > 0 && _blocks[_current].start > mark) --_current;
+    _offset = mark - _blocks[_current].start;
+    _used = mark;
+    _last = nullptr;
+}
+
+std::size_t Arena::capacity() const {
+    std::size_t size = 0;
+    for (const Block& held : _blocks) size += held.size;
+    return size;
+}
+
+Arena& queryArena() {
+    static thread_local Arena arena;
+    return arena;
+}
@@ -0,0 +1,143 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Size of the first block of a query arena, enough for a whole query
+// on any board so the arena only grows on unusual requests
+#define ARENA_BYTES (64 * 1024)
+
+/**
+ * Scratch memory for one query at a time.
+ *
+ * Allocating bumps a pointer and nothing is freed on its own: the whole
+ * arena is rewound in one go when the query ends. If a query needs more
+ * than the arena holds, another block is added, and once the arena is
+ * empty again the blocks are replaced by one block big enough for all
+ * of them. So after the largest query has been seen once, queries never
+ * reach the heap. Only types that need no destructor can live in it.
+ */
+class Arena {
+public:
+    explicit Arena(std::size_t bytes = ARENA_BYTES);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * Uninitialised space for count objects, aligned for the type
+     */
+    template <typename T>
+    T* allocate(std::size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+        return static_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * Makes room for more objects at the end of an array.
+     * The array grows in place if it was the last thing allocated,
+     * otherwise it is copied to new space.
+     * @return The array, which may have moved
+     */
+    template <typename T>
+    T* grow(T* data, std::size_t count, std::size_t new_count) {
+        static_assert(std::is_trivially_copyable<T>::value, "Arena arrays are moved by copying bytes");
+        return static_cast<T*>(growBytes(data, count * sizeof(T), new_count * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * Point to rewind to, everything allocated after it is given back
+     */
+    typedef std::size_t Mark;
+    Mark mark() const { return _used; }
+    void rewind(Mark mark);
+
+    /**
+     * Gives back everything
+     */
+    void reset() { rewind(0); }
+
+    /**
+     * Bytes handed out and bytes held
+     */
+    std::size_t used() const { return _used; }
+    std::size_t capacity() const;
+
+private:
+    void* allocateBytes(std::size_t bytes, std::size_t alignment);
+    void* growBytes(void* data, std::size_t bytes, std::size_t new_bytes, std::size_t alignment);
+
+    typedef struct Block {
+        std::unique_ptr<char[]> memory;
+        std::size_t size;
+        std::size_t start;      // Bytes used by the blocks before this one
+    } block;
+
+    std::vector<Block> _blocks;
+    std::size_t _current;       // Block being allocated from
+    std::size_t _offset;        // Bytes used in the current block
+    std::size_t _used;          // Bytes used in all the blocks
+    void* _last;                // Most recent allocation, the only one that can grow in place
+};
+
+/**
+ * Rewinds an arena to where it was when the scope began,
+ * so a query gives back its scratch however it returns
+ */
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) : _arena(arena), _mark(arena.mark()) {};
+    ~ArenaScope() { _arena.rewind(_mark); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena& _arena;
+    Arena::Mark _mark;
+};
+
+/**
+ * Growing array in an arena, for scratch results whose number isn't known up front
+ */
+template <typename T>
+class ScratchList {
+public:
+    explicit ScratchList(Arena& arena, std::size_t capacity = 16) :
+        _arena(arena), _data(arena.allocate<T>(capacity)), _size(0), _capacity(capacity) {};
+
+    void push_back(const T& value) {
+        if (_size == _capacity) {
+            _data = _arena.grow(_data, _capacity, _capacity << 1);
+            _capacity <<= 1;
+        }
+        _data[_size++] = value;
+    }
+
+    void clear() { _size = 0; }
+    bool empty() const { return _size == 0; }
+    std::size_t size() const { return _size; }
+    T& operator[](std::size_t idx) { return _data[idx]; }
+    const T& operator[](std::size_t idx) const { return _data[idx]; }
+    T* begin() { return _data; }
+    T* end() { return _data + _size; }
+    const T* begin() const { return _data; }
+    const T* end() const { return _data + _size; }
+
+private:
+    Arena& _arena;
+    T* _data;
+    std::size_t _size;
+    std::size_t _capacity;
+};
+
+/**
+ * Arena of the calling thread, shared by every query the thread runs
+ */
+Arena& queryArena();
+
+#endif /* ARENA_H */
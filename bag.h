@@ -0,0 +1,60 @@
+#ifndef BAG_H
+#define BAG_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "board.h"
+
+/**
+ * Tiles of a full bag, '?' for a blank
+ */
+inline std::string fullBag() {
+    std::string tiles;
+    for (int idx = 0; idx < 26; ++idx) tiles.append((std::size_t) LETTER_TILES[idx], (char) ('A' + idx));
+    tiles.append((std::size_t) BLANK_TILES, WILDCARD_ALIAS);
+    return tiles;
+}
+
+/**
+ * Tiles waiting to be drawn, in random order.
+ * Each draw takes a random tile from the ones that are left, so the
+ * tiles don't need to be shuffled up front. The same tiles and seed
+ * always draw the same tiles.
+ */
+class TileBag {
+public:
+    /**
+     * @param tiles
+     *          Tiles in the bag, '?' for a blank
+     * @param seed
+     *          Seed of the draws
+     */
+    TileBag(const std::string& tiles, std::uint64_t seed) : _tiles(tiles), _left(tiles.size()), _random(seed) {};
+
+    /**
+     * Number of tiles left
+     */
+    std::size_t size() const { return _left; }
+
+    bool empty() const { return _left == 0; }
+
+    /**
+     * Draws tiles until the rack is full or the bag is empty
+     */
+    void draw(std::string& rack) {
+        while (rack.size() < RACK_SIZE && _left > 0) {
+            std::size_t idx = std::uniform_int_distribution<std::size_t>(0, _left - 1)(_random);
+            std::swap(_tiles[idx], _tiles[--_left]);
+            rack += _tiles[_left];
+        }
+    }
+
+private:
+    std::string _tiles;
+    std::size_t _left;
+    std::mt19937_64 _random;
+};
+
+#endif /* BAG_H */
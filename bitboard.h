@@ -0,0 +1,125 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+
+// Width of the board and number of squares covered by a bitboard
+#define BITBOARD_WIDTH 15
+#define BITBOARD_SQUARES (BITBOARD_WIDTH * BITBOARD_WIDTH)
+
+/**
+ * One bit for each of the 225 squares of the board, stored in
+ * four 64-bit words. Bit i is the square with index i, so for a
+ * board stored line by line (y * 15 + x) moving one square to the
+ * right is a shift by one and moving one square down is a shift
+ * by fifteen.
+ */
+typedef struct Bitboard {
+    std::uint64_t bits[4];
+
+    /**
+     * Bitboard default constructor
+     * Defaults: No bits set
+     */
+    Bitboard() { bits[0] = bits[1] = bits[2] = bits[3] = 0; };
+
+    bool test(int idx) const { return (bits[idx >> 6] >> (idx & 63)) & 1u; }
+    void set(int idx) { bits[idx >> 6] |= (std::uint64_t) 1 << (idx & 63); }
+    void clear(int idx) { bits[idx >> 6] &= ~((std::uint64_t) 1 << (idx & 63)); }
+
+    bool none() const { return !(bits[0] | bits[1] | bits[2] | bits[3]); }
+
+    int count() const {
+        int total = 0;
+        for (int i = 0; i < 4; ++i) {
+            #if defined(__GNUC__)
+                total += __builtin_popcountll(bits[i]);
+            #else
+                for (std::uint64_t b = bits[i]; b; b &= b - 1) ++total;
+            #endif
+        }
+        return total;
+    }
+
+    Bitboard operator|(const Bitboard& other) const {
+        Bitboard result;
+        for (int i = 0; i < 4; ++i) result.bits[i] = bits[i] | other.bits[i];
+        return result;
+    }
+
+    Bitboard operator&(const Bitboard& other) const {
+        Bitboard result;
+        for (int i = 0; i < 4; ++i) result.bits[i] = bits[i] & other.bits[i];
+        return result;
+    }
+
+    /**
+     * Complement, limited to the squares that are on the board
+     */
+    Bitboard operator~() const {
+        Bitboard result;
+        for (int i = 0; i < 4; ++i) result.bits[i] = ~bits[i];
+        result.bits[3] &= LAST_WORD_MASK;
+        return result;
+    }
+
+    bool operator==(const Bitboard& other) const {
+        return bits[0] == other.bits[0] && bits[1] == other.bits[1] &&
+               bits[2] == other.bits[2] && bits[3] == other.bits[3];
+    }
+
+    /**
+     * Moves every bit n (1-63) squares towards the higher indices,
+     * bits moved past the last square are dropped
+     */
+    Bitboard shiftUp(int n) const {
+        Bitboard result;
+        for (int i = 3; i >= 0; --i) {
+            result.bits[i] = bits[i] << n;
+            if (i > 0) result.bits[i] |= bits[i - 1] >> (64 - n);
+        }
+        result.bits[3] &= LAST_WORD_MASK;
+        return result;
+    }
+
+    /**
+     * Moves every bit n (1-63) squares towards the lower indices
+     */
+    Bitboard shiftDown(int n) const {
+        Bitboard result;
+        for (int i = 0; i < 4; ++i) {
+            result.bits[i] = bits[i] >> n;
+            if (i < 3) result.bits[i] |= bits[i + 1] << (64 - n);
+        }
+        return result;
+    }
+
+    /**
+     * Squares directly next to (left, right, above or below) a set square.
+     * Shifting by one square would wrap around to the next line, so the
+     * first or last square of each line is masked off.
+     */
+    Bitboard neighbors() const {
+        static const Bitboard not_first = ~column(0);
+        static const Bitboard not_last = ~column(BITBOARD_WIDTH - 1);
+
+        Bitboard right = shiftUp(1) & not_first;
+        Bitboard left = shiftDown(1) & not_last;
+        return right | left | shiftUp(BITBOARD_WIDTH) | shiftDown(BITBOARD_WIDTH);
+    }
+
+    /**
+     * Every square at the given position of a line
+     */
+    static Bitboard column(int col) {
+        Bitboard result;
+        for (int idx = col; idx < BITBOARD_SQUARES; idx += BITBOARD_WIDTH) result.set(idx);
+        return result;
+    }
+
+private:
+    // Bits of the last word that are on the board
+    static const std::uint64_t LAST_WORD_MASK = ((std::uint64_t) 1 << (BITBOARD_SQUARES - 192)) - 1;
+} bitboard;
+
+#endif /* BITBOARD_H */
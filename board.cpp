@@ -1,4 +1,7 @@
 #include "board.h"
+#include "anagram.h"
+#include "lexicon.h"
+#include "movegen.h"
 
 /**
  * Checks if the board is empty or not
@@ -6,9 +9,9 @@
  *         Scrabble board
  * @return True if the board is empty, else return false
  */
-bool boardIsEmpty(const Board board) {
+bool boardIsEmpty(const Board& board) {
     // A word will always pass through the middle tile
-    return (board.tiles[7][7].letter == '-');
+    return (board.getTile(BOARD_SIZE >> 1, BOARD_SIZE >> 1) == EMPTY);
 }
 
 /**
@@ -29,6 +32,18 @@ std::unordered_set<std::string> initializeWordSet() {
     return new_set;
 }
 
+/**
+ * Checks if the word can be made out of the given letters
+ * @param letters
+ *          Letters that can be used to make the word
+ * @param word
+ *          Word to be made
+ * @return True if every letter of the word is in the letters
+ */
+bool canMakeWord(const std::vector<char>& letters, const std::string& word) {
+	return LetterCounts::of(word).fitsIn(LetterCounts::of(std::string(letters.begin(), letters.end())));
+}
+
 /**
  * Retrieves all possible words given the combination of letters
  * @param letters
@@ -36,22 +51,14 @@ std::unordered_set<std::string> initializeWordSet() {
  * @return Vector full of possible words given the letters
  */
 std::vector<std::string> getPossibleWords(std::vector<char> letters) {
-	std::vector<char> _compare;
-	std::vector<std::string> _matches, _adjusted_matches;
+	std::vector<std::string> _matches;
+	LetterCounts _rack = LetterCounts::of(std::string(letters.begin(), letters.end()));
 
 	std::ifstream _file(DICTIONARY);
 	if (_file.is_open()) {
-		std::string _word, _temp;
+		std::string _word;
 		while (std::getline(_file, _word)) {
-			_compare = letters;
-			_temp = _word;
-			while (!_word.empty()) {
-				char c = _word[0];
-				std::vector<char>::iterator it = find(_compare.begin(), _compare.end(), c);
-				if (it != _compare.end()) { _compare.erase(it); _word.erase(find(_word.begin(), _word.end(), c)); }
-				else break;
-			}
-			if (_word.empty()) { _matches.push_back(_temp); }
+			if (LetterCounts::of(_word).fitsIn(_rack)) { _matches.push_back(_word); }
 		}
 	}
     else 
@@ -60,6 +67,19 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
 	return _matches;
 }
 
+/**
+ * Retrieves all possible words given the combination of letters
+ * by looking up the subsets of the letters in the anagram index
+ * @param index
+ *          Anagram index of the Scrabble dictionary
+ * @param letters
+ *          Find all possible words using these letters
+ * @return Vector full of possible words given the letters
+ */
+std::vector<std::string> getPossibleWords(const AnagramIndex& index, std::vector<char> letters) {
+	return index.subanagrams(std::string(letters.begin(), letters.end()));
+}
+
 /**
  * The probabilistic method is quicker but is potentially less
  * accurate than brute-forcing in an attempt to find the best word.
@@ -74,7 +94,7 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
      * @param tile
      *          Target tile on the scrabble board
      */
-    int getBestDirection(const Board board, const Tile tile) {
+    int getBestDirection(const Board& board, const Tile& tile) {
         
         // If the tiles to the left and right of the target tile
         // are both empty, the best direction is horizontal
@@ -229,6 +249,7 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
 
         // Changing the tile's probability to the new one
         tile.probability = probability;
+        board.probabilities[tile.y * BOARD_SIZE + tile.x] = probability;
     }
 
     /**
@@ -242,8 +263,38 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
         // that a word can be created on that tile.
         for (std::size_t y = 0; y < BOARD_SIZE; ++y) {
             for (std::size_t x = 0; x < BOARD_SIZE; ++x) {
-                if (board.tiles[x][y].letter != EMPTY)
-                    calcTileProbability(board, board.tiles[x][y]);
+                board.probabilities[y * BOARD_SIZE + x] = 0.0;
+                if (board.getTile(x, y) != EMPTY) {
+                    Tile tile = board.tile(x, y);
+                    calcTileProbability(board, tile);
+                }
+            }
+        }
+        board.probabilities_ready = true;
+    }
+
+    /**
+     * Recalculates the probabilities of the tiles close enough to
+     * the given square to be affected by a change on it
+     * @param board
+     *          Scrabble board
+     * @param x
+     *          X-coordinate of the square that changed
+     * @param y
+     *          Y-coordinate of the square that changed
+     */
+    void updateProbabilitiesAround(Board& board, std::size_t x, std::size_t y) {
+        // A tile looks at most this far away when calculating its probability
+        const int reach = PROB_CALC_SIZE + 1;
+
+        for (int ty = (int) y - reach; ty <= (int) y + reach; ++ty) {
+            for (int tx = (int) x - reach; tx <= (int) x + reach; ++tx) {
+                if (board.getTile(tx, ty) == OUT_OF_BOUNDS) continue;
+                board.probabilities[ty * BOARD_SIZE + tx] = 0.0;
+                if (board.getTile(tx, ty) != EMPTY) {
+                    Tile tile = board.tile(tx, ty);
+                    calcTileProbability(board, tile);
+                }
             }
         }
     }
@@ -254,7 +305,8 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
     Tile* getHighestProbabilities(Board& board) {
 
         // Initialize probabilities of tiles on the board
-        getProbabilities(board);
+        if (!board.probabilities_ready)
+            getProbabilities(board);
 
         // Temporary array for storing highest probabilities
         double temp_prob[PROB_ARRAY_SIZE] = { 0.0 };
@@ -264,7 +316,7 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
 
         for (std::size_t y = 0; y < BOARD_SIZE; ++y) {
             for (std::size_t x = 0; x < BOARD_SIZE; ++x) {
-                Tile& temp_tile = board.tiles[x][y];
+                Tile temp_tile = board.tile(x, y);
 
                 // Skip any empty tiles
                 if (temp_tile.letter == EMPTY) continue;
@@ -289,117 +341,44 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
     }
 
     /**
-     * Determines if the move at the tile is possible or not
+     * Determines if the move at the tile is possible or not.
+     * Every letter that is placed must be allowed by the cross-checks
+     * of its square, which also hold the points of the perpendicular word.
      * @param board
-     *              Status of the Scrabble board
-     * @param scrabble_words
-     *              Set of Scrabble words
+     *              Status of the Scrabble board with its cross-checks computed
      * @param move
      *              Move to be evaluated for validity
      * @return True if the move is possible,
      *         False if the move violates the rules
      */
-    bool isPossibleMove(const Board board, std::unordered_set<std::string> scrabble_words, Move& move) {
-        // If the move direction is vertical, every tile that is placed vertically
-        // must also make valid words with adjacent letters horizontally or must be isolated.
-        if (move.direction == VERTICAL) {
-            for (std::size_t i = 0; i < move.word.length(); ++i) {
-                // Position of current tile relative to anchor point
-                int y = move.anchorY + (int) i;
-                
-                // If one of the tiles is out of bounds, the move isn't possible
-                if (board.getTile(move.anchorX, y) == OUT_OF_BOUNDS) return false;
-
-                // If the tile is part of a word that has already been placed, ignore it
-                if (move.pivotX == move.anchorX && move.pivotY == y)
-                    continue;
-
-                // Use deque to construct a word using push front and back
-                std::deque<char> check_word;
-                check_word.push_back(move.word[i]);
-                
-                // Check if there are any letters to the left
-                int posX = move.anchorX;
-                char prev_letter = board.getTile(--posX, y);
-                while (prev_letter != EMPTY && prev_letter != OUT_OF_BOUNDS) {
-                    check_word.push_front(prev_letter);
-                    prev_letter = board.getTile(--posX, y);
-                }
-
-                // Check if there are any letters to the right
-                posX = move.anchorX;
-                char next_letter = board.getTile(++posX, y);
-                while (next_letter != EMPTY && next_letter != OUT_OF_BOUNDS) {
-                    check_word.push_back(next_letter);
-                    next_letter = board.getTile(++posX, y);
-                }
-
-                // Convert deque sequence to string
-                std::string word_from_deque;
-                for (int i = 0; i < check_word.size(); ++i)
-                    word_from_deque += check_word[i];
-
-                // Check if the letter is isolated or if it makes a word with adjacent tiles
-                if (word_from_deque.length() != 1 && !scrabble_words.count(word_from_deque)) {
-                    return false;
-                }
-
-                // If it is a valid move, the move's points need to be adjusted for a new word being created
-                if (word_from_deque.length() != 1)
-                    move.points += getPointValueOfWord(word_from_deque);
-            }
-
-        } /* VERTICAL */
-
-        // If the move direction is horizontal, every tile that is placed horizontally
-        // must also make valid words with adjacent letters vertically or must be isolated.
-        else {
-            for (std::size_t i = 0; i < move.word.length(); ++i) {
-                // Position of current tile relative to anchor point
-                int x = move.anchorX + (int) i;
-
-                // If one of the tiles is out of bounds, the move isn't possible
-                if (board.getTile(x, move.anchorY) == OUT_OF_BOUNDS) return false;
-
-                // If the tile is part of a word that is already played, ignore it
-                if (move.pivotX == x && move.pivotY == move.anchorY)
-                    continue;
+    bool isPossibleMove(const Board& board, Move& move) {
+        int dx = (move.direction == HORIZONTAL) ? 1 : 0;
+        int dy = (move.direction == VERTICAL) ? 1 : 0;
 
-                // Use deque to construct a word using push front and back
-                std::deque<char> check_word;
-                check_word.push_back(move.word[i]);
-                
-                // Check if there are any letters above
-                int posY = move.anchorY;
-                char prev_letter = board.getTile(x, --posY);
-                while (prev_letter != EMPTY && prev_letter != OUT_OF_BOUNDS) {
-                    check_word.push_front(prev_letter);
-                    prev_letter = board.getTile(x, --posY);
-                }
-
-                // Check if there are any letters below
-                posY = move.anchorY;
-                char next_letter = board.getTile(x, ++posY);
-                while (next_letter != EMPTY && next_letter != OUT_OF_BOUNDS) {
-                    check_word.push_back(next_letter);
-                    next_letter = board.getTile(x, ++posY);
-                }
-
-                // Convert deque sequence to string
-                std::string word_from_deque;
-                for (int i = 0; i < check_word.size(); ++i)
-                    word_from_deque += check_word[i];
+        for (std::size_t i = 0; i < move.word.length(); ++i) {
+            // Position of current tile relative to anchor point
+            int x = move.anchorX + (int) i * dx;
+            int y = move.anchorY + (int) i * dy;
 
-                // Check if the letter is isolated or if it makes a word with adjacent tiles
-                if (word_from_deque.length() != 1 && !scrabble_words.count(word_from_deque)) {
-                    return false;
-                }
+            // If one of the tiles is out of bounds, the move isn't possible
+            if (board.getTile(x, y) == OUT_OF_BOUNDS) return false;
 
-                // If it is a valid move, the move's points need to be adjusted for a new word being created
-                move.points += getPointValueOfWord(word_from_deque);
-            }
+            // If the tile is part of a word that has already been placed, ignore it
+            if (move.pivotX == x && move.pivotY == y)
+                continue;
 
-        } /* HORIZONTAL */
+            // The letter must make a valid word with adjacent tiles or be isolated
+            char letter = move.word[i];
+            int idx = Board::lineIndex(move.direction, x, y);
+            if (letter < 'A' || letter > 'Z' ||
+                !((board.cross_checks[move.direction][idx] >> (letter - 'A')) & 1u))
+                return false;
+
+            // If it is a valid move, the move's points need to be adjusted for a new word being created
+            int perpendicular = board.cross_points[move.direction][idx];
+            if (perpendicular >= 0)
+                move.points += perpendicular + letterValue(letter);
+        }
 
         return true;
     }
@@ -411,15 +390,26 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
      *              State of the Scrabble board
      * @param letters
      *              Letters in the hands of the user
+     * @param index
+     *              Anagram index of the Scrabble dictionary
+     * @param stats
+     *              Filled in with what the search did, if not null
      * @return The best move to play given the board status and letters in hand
      */
-    Move findBestWord(Board& board, std::string letters) {
+    Move findBestWord(Board& board, std::string letters, const AnagramIndex& index, QueryStats* stats) {
+        STATS(QueryStats counted);
+        STATS(auto search_start = std::chrono::steady_clock::now());
+
+        Arena& arena = queryArena();
+        ArenaScope scope(arena);
+
         /**
          * If the board is empty, the first word must go through
          * the middle square on the Scrabble board (7, 7).
          * The first word can only be made of the tiles that
          * the user is currently holding in their hand.
-         * The first word also automatically receives double points.
+         * The double word square in the middle comes from BONUS_LAYOUT,
+         * so the first word is scored like any other move.
          */
         if (boardIsEmpty(board)) {
             
@@ -428,12 +418,11 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
             first_move.direction = HORIZONTAL;
             first_move.anchorY = (BOARD_SIZE >> 1);
 
-            // Transforms string to vector of chars
-            std::vector<char> letter_vector(letters.length());
-            std::copy(letters.begin(), letters.end(), letter_vector.begin());
-
-            // Retrieve all possible words
-            std::vector<std::string> words_with_given_letters = getPossibleWords(letter_vector);
+            // Retrieve all possible words, kept in the query's scratch which is given back on return
+            ScratchList<const std::string*> words_with_given_letters(arena);
+            index.subanagrams(letters, words_with_given_letters);
+            STATS(++counted.lookups);
+            STATS(counted.words += words_with_given_letters.size());
 
             // Temporary move is used for comparison with current best move
             Move temp_move;
@@ -445,21 +434,24 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
             for (std::size_t idx = 0; idx < words_with_given_letters.size(); ++idx) {
 
                 // Change properties of temporary word to find the points for that move
-                std::string temp_word = words_with_given_letters[idx];
+                const std::string& temp_word = *words_with_given_letters[idx];
                 temp_move.anchorX = (BOARD_SIZE >> 1) - (int) (temp_word.length() >> 1);
                 temp_move.word = temp_word;
                 std::size_t temp_points = getPointValueOfMove(temp_move);
+                STATS(++counted.placements);
 
                 // If the temp move is better than prev move, make it the new best move
-                if (temp_points > points) {
+                if (first_move.word.empty() || temp_points > points) {
                     points = temp_points;
                     first_move.anchorX = temp_move.anchorX;
                     first_move.word = temp_word;
                 }
             }
 
-            // First move gets double points
-            first_move.points = points << 1;
+            first_move.points = points;
+
+            STATS(counted.search_ns = QueryStats::since(search_start));
+            STATS(if (stats) stats->add(counted));
             return first_move;
 
         }
@@ -471,8 +463,14 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
          * that are currently in the player's hand.
          */
         Move best_move;
-        std::unordered_set<std::string> scrabble_words = initializeWordSet();
         Tile* highest_probs = getHighestProbabilities(board);
+        STATS(counted.probability_ns = QueryStats::since(search_start));
+
+        // The rack and the letter of the target tile, the letter changes for every tile
+        std::string target_letters = letters + EMPTY;
+
+        // The words of each tile are kept in the query's scratch, which is given back on return
+        ScratchList<const std::string*> possible_words(arena);
 
         // Find the best move for each tile in the highest probabilities list
         for (std::size_t idx = 0; idx < PROB_ARRAY_SIZE; ++idx) {
@@ -480,11 +478,7 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
             Tile target_tile = highest_probs[idx];
             m.pivotX = target_tile.x;
             m.pivotY = target_tile.y;
-            std::string target_letters = letters + target_tile.letter;
-
-            // Transforms string to vector of chars
-            std::vector<char> letter_vector(target_letters.length());
-            std::copy(target_letters.begin(), target_letters.end(), letter_vector.begin());
+            target_letters.back() = target_tile.letter;
 
             m.direction = getBestDirection(board, target_tile);
 
@@ -493,9 +487,11 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
             else if (m.direction == HORIZONTAL) m.anchorY = (int) target_tile.y;
 
             // Iterate through possible words on spot to find best word
-            std::vector<std::string> possible_words = getPossibleWords(letter_vector);
+            possible_words.clear();
+            index.subanagrams(target_letters, possible_words);
+            STATS(++counted.lookups);
             for (auto it = possible_words.begin(); it != possible_words.end(); ++it) {
-                m.word = *it;
+                m.word = **it;
                 
                 // Determine anchor points from direction and placement of letter
                 // on the current word being examined for validity
@@ -509,23 +505,21 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
                     else if (m.direction == HORIZONTAL) m.anchorX = (int) target_tile.x - (int) found_idx;
 
                     // Tests if the move is possible and then calculates the total points of the move
-                    // auto timer_start = std::chrono::system_clock::now();
+                    STATS(++counted.words);
+                    STATS(++counted.placements);
                     getPointValueOfMove(m);
-                    if (m.points > best_move.points) {  
-                        std::cout << m.points << ", " << best_move.points << std::endl;
-                        if (isPossibleMove(board, scrabble_words, m)) {
-                            m.print();
+                    if (best_move.word.empty() || m.points > best_move.points) {
+                        bool possible = isPossibleMove(board, m);
+                        STATS(if (!possible) ++counted.rejected);
+                        if (possible) {
                             best_move.anchorX = m.anchorX;
                             best_move.anchorY = m.anchorY;
                             best_move.direction = m.direction;
                             best_move.points = m.points;
-                            best_move.word = *it;
+                            best_move.word = m.word;
                         }
                     }
                     m.points = 0;
-                    // auto timer_end = std::chrono::system_clock::now();
-                    // std::chrono::duration<double> elapsed = timer_end - timer_start;
-                    // std::cout << elapsed.count() << std::endl;
 
                     // Adjusts the start of searching for the target letter in the word
                     // in case there are duplicate letters of the target letter
@@ -536,6 +530,8 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
 
         }
 
+        STATS(counted.search_ns = QueryStats::since(search_start) - counted.probability_ns);
+        STATS(if (stats) stats->add(counted));
         return best_move;
     }
 #endif
@@ -544,12 +540,212 @@ std::vector<std::string> getPossibleWords(std::vector<char> letters) {
  * Using a brute-force method to find the best word
  */
 #if (METHOD == BRUTE_FORCE)
-    // TODO
-    Move& findBestWord(Board board, std::string letters) {
-        return "";
+
+    /**
+     * Finds the best word given the current state of the board
+     * and a set of letters that the user has by generating the legal
+     * moves from every anchor square in both directions. Words that
+     * can't score more than the best move so far are cut off early.
+     * @param board
+     *              State of the Scrabble board
+     * @param letters
+     *              Letters in the hands of the user
+     * @param gaddag
+     *              GADDAG of the Scrabble dictionary
+     * @param stats
+     *              Filled in with what the search did, if not null
+     * @param leaves
+     *              Equity of the tiles left on the rack, if not null
+     * @return The move with the most equity given the board status and letters in hand
+     */
+    Move findBestWord(Board& board, std::string letters, const Gaddag& gaddag, QueryStats* stats,
+                      const LeaveTable* leaves) {
+        STATS(auto search_start = std::chrono::steady_clock::now());
+        MoveGenerator generator(gaddag, leaves);
+        Move best_move = generator.best(board, letters);
+
+        STATS(if (stats) {
+            stats->add(generator.stats());
+            stats->search_ns += QueryStats::since(search_start);
+        });
+        return best_move;
     }
 #endif
 
+/**
+ * Finds the best moves given the current state of the board and a set
+ * of letters that the user has by generating every legal move
+ * @param board
+ *              State of the Scrabble board
+ * @param letters
+ *              Letters in the hands of the user
+ * @param k
+ *              Number of moves to return
+ * @param gaddag
+ *              GADDAG of the Scrabble dictionary
+ * @param leaves
+ *              Equity of the tiles left on the rack, if not null
+ * @return Up to k moves from most to least equity, moves with the same
+ *         equity in the order they are generated
+ */
+std::vector<Move> findTopMoves(Board& board, std::string letters, std::size_t k, const Gaddag& gaddag,
+                               const LeaveTable* leaves) {
+    TopMoves top(k);
+    MoveGenerator generator(gaddag, leaves);
+    generator.generate(board, letters, [&top](const Move& m) { top.offer(m); });
+    return top.sorted();
+}
+
+/**
+ * Computes the cross-checks of a single square for both directions
+ * @param board
+ *          Scrabble board
+ * @param gaddag
+ *          GADDAG of the Scrabble dictionary
+ * @param x
+ *          X-coordinate
+ * @param y
+ *          Y-coordinate
+ */
+void computeCrossCheck(Board& board, const Gaddag& gaddag, std::size_t x, std::size_t y) {
+    char letter = board.getTile(x, y);
+
+    int row = Board::lineIndex(HORIZONTAL, x, y), col = Board::lineIndex(VERTICAL, x, y);
+
+    // An occupied square only allows the letter already on it
+    if (letter != EMPTY) {
+        std::uint32_t mask = (letter >= 'A' && letter <= 'Z') ? 1u << (letter - 'A') : 0;
+        board.cross_checks[HORIZONTAL][row] = board.cross_checks[VERTICAL][col] = mask;
+        board.cross_points[HORIZONTAL][row] = board.cross_points[VERTICAL][col] = -1;
+        return;
+    }
+
+    // Letters above and below constrain horizontal moves,
+    // letters to the left and right constrain vertical moves
+    const int dx[2] = {1, 0}, dy[2] = {0, 1};
+    for (int direction = VERTICAL; direction <= HORIZONTAL; ++direction) {
+        std::string before, after;
+        int points = 0;
+
+        int px = (int) x - dx[direction], py = (int) y - dy[direction];
+        for (char c = board.getTile(px, py); c != EMPTY && c != OUT_OF_BOUNDS; c = board.getTile(px, py)) {
+            before.insert(before.begin(), c);
+            points += board.tilePoints(px, py);
+            px -= dx[direction]; py -= dy[direction];
+        }
+        px = (int) x + dx[direction]; py = (int) y + dy[direction];
+        for (char c = board.getTile(px, py); c != EMPTY && c != OUT_OF_BOUNDS; c = board.getTile(px, py)) {
+            after += c;
+            points += board.tilePoints(px, py);
+            px += dx[direction]; py += dy[direction];
+        }
+
+        int idx = (direction == HORIZONTAL) ? row : col;
+        if (before.empty() && after.empty()) {
+            board.cross_checks[direction][idx] = ALL_LETTERS;
+            board.cross_points[direction][idx] = -1;
+        }
+        else {
+            board.cross_checks[direction][idx] = gaddag.crossCheck(before, after);
+            board.cross_points[direction][idx] = (std::int16_t) points;
+        }
+    }
+}
+
+/**
+ * Computes the cross-checks of every square on the board
+ * @param board
+ *          Scrabble board
+ * @param gaddag
+ *          GADDAG of the Scrabble dictionary
+ */
+void computeCrossChecks(Board& board, const Gaddag& gaddag) {
+    for (std::size_t y = 0; y < BOARD_SIZE; ++y) {
+        for (std::size_t x = 0; x < BOARD_SIZE; ++x)
+            computeCrossCheck(board, gaddag, x, y);
+    }
+    board.gaddag = &gaddag;
+    board.cross_checks_ready = true;
+}
+
+/**
+ * Updates what depends on the square after its tile changed.
+ * Besides the square itself, only the first empty square past
+ * the tiles in each of the four directions has a different
+ * perpendicular word, so only those cross-checks are recomputed.
+ */
+void Board::updateAround(std::size_t x, std::size_t y) {
+    if (cross_checks_ready) {
+        computeCrossCheck(*this, *gaddag, x, y);
+
+        const int dx[4] = {-1, 1, 0, 0}, dy[4] = {0, 0, -1, 1};
+        for (int d = 0; d < 4; ++d) {
+            int px = (int) x + dx[d], py = (int) y + dy[d];
+            while (getTile(px, py) != EMPTY && getTile(px, py) != OUT_OF_BOUNDS) {
+                px += dx[d]; py += dy[d];
+            }
+            if (getTile(px, py) == EMPTY)
+                computeCrossCheck(*this, *gaddag, px, py);
+        }
+    }
+
+    #if (METHOD == PROBABILISTIC)
+        if (probabilities_ready)
+            updateProbabilitiesAround(*this, x, y);
+    #endif
+}
+
+bool Board::apply(const Move& move) {
+    int dx = (move.direction == HORIZONTAL) ? 1 : 0;
+    int dy = (move.direction == VERTICAL) ? 1 : 0;
+    if (!dx && !dy) return false;
+
+    // Find the squares that need a new tile before changing anything
+    Placement placed;
+    placed.count = 0;
+    for (std::size_t i = 0; i < move.word.length(); ++i) {
+        int x = move.anchorX + (int) i * dx, y = move.anchorY + (int) i * dy;
+        char square = getTile(x, y);
+        char letter = (char) std::toupper(move.word[i]);
+
+        if (square == OUT_OF_BOUNDS) return false;
+        if (square == EMPTY) {
+            if (placed.count == RACK_SIZE) return false;
+            placed.squares[placed.count++] = (std::uint8_t) (y * BOARD_SIZE + x);
+        }
+        else if (square != letter) return false;
+    }
+    if (!placed.count) return false;
+
+    for (int i = 0; i < placed.count; ++i) {
+        std::size_t x = placed.squares[i] % BOARD_SIZE, y = placed.squares[i] / BOARD_SIZE;
+        std::size_t offset = (move.direction == HORIZONTAL) ? x - move.anchorX : y - move.anchorY;
+        setTile(x, y, move.word[offset]);
+    }
+    for (int i = 0; i < placed.count; ++i)
+        updateAround(placed.squares[i] % BOARD_SIZE, placed.squares[i] / BOARD_SIZE);
+
+    history.push_back(placed);
+    return true;
+}
+
+bool Board::undo() {
+    if (history.empty()) return false;
+    Placement placed = history.back();
+    history.pop_back();
+
+    for (int i = 0; i < placed.count; ++i) {
+        std::size_t x = placed.squares[i] % BOARD_SIZE, y = placed.squares[i] / BOARD_SIZE;
+        setTile(x, y, EMPTY);
+        #if (METHOD == PROBABILISTIC)
+            probabilities[placed.squares[i]] = 0.0;
+        #endif
+    }
+    for (int i = 0; i < placed.count; ++i)
+        updateAround(placed.squares[i] % BOARD_SIZE, placed.squares[i] / BOARD_SIZE);
+    return true;
+}
+
 /**
  * Creates the scrabble board from the given file
  * @param filename 
@@ -560,28 +756,116 @@ Board createBoardFromFile(const std::string filename) {
     Board board;
 
     std::ifstream _file(filename);
-	if (_file.is_open()) {
-		std::string _line;
-        std::size_t row = 0;
-		while (std::getline(_file, _line)) {
-            std::size_t col = 0;
-            for (char c : _line) {
-                c = std::toupper(c);
-                Tile _new_tile;
-                _new_tile.letter = c;
-                _new_tile.points = _letter_values[c];
-                _new_tile.x = col;
-                _new_tile.y = row;
-                board.tiles[col++][row] = _new_tile;
-            }
-            ++row;
-        }
-    }
+	if (_file.is_open())
+        readBoard(_file, board);
     else 
         std::cout << "File name not found\n";
     return board;
 }
 
+/**
+ * Reads the rows of a scrabble board from a stream, one line per row.
+ * Uppercase letters are tiles, lowercase letters are blank tiles.
+ * @param input
+ *          Stream positioned at the first row of the board
+ * @param board
+ *          Board the letters are placed on
+ * @return True if every row of the board was read
+ */
+bool readBoard(std::istream& input, Board& board) {
+    std::string _line;
+    std::size_t row = 0;
+    while (row < BOARD_SIZE && std::getline(input, _line)) {
+        std::size_t col = 0;
+        for (char c : _line) {
+            if (col < BOARD_SIZE)
+                board.setTile(col, row, c);
+            ++col;
+        }
+        ++row;
+    }
+    return row == BOARD_SIZE;
+}
+
+/**
+ * Reads the next position from a stream.
+ * A position is a line with the rack followed by the rows of the board,
+ * blank lines and lines starting with '#' before the rack are skipped.
+ * @param input
+ *          Stream of positions
+ * @param board
+ *          Set to the board of the position
+ * @param rack
+ *          Set to the letters in the hands of the user
+ * @return True if a whole position was read
+ */
+bool readPosition(std::istream& input, Board& board, std::string& rack) {
+    std::string _line;
+    while (std::getline(input, _line)) {
+        if (_line.empty() || _line[0] == '#') continue;
+        rack = _line;
+        board = Board();
+        return readBoard(input, board);
+    }
+    return false;
+}
+
+/**
+ * Reads a position written on a single line: the rack, a space and the
+ * 225 squares of the board row by row ('-' for an empty square, a
+ * lowercase letter for a blank tile). Rows may be separated by '/'.
+ * @param line
+ *          Line holding the position
+ * @param board
+ *          Set to the board of the position
+ * @param rack
+ *          Set to the letters in the hands of the user
+ * @return True if the line holds a rack and every square of the board
+ */
+bool parsePosition(const std::string& line, Board& board, std::string& rack) {
+    std::size_t split = line.find(' ');
+    if (split == 0 || split == std::string::npos) return false;
+    rack = line.substr(0, split);
+    board = Board();
+
+    std::size_t square = 0;
+    for (std::size_t idx = split + 1; idx < line.length(); ++idx) {
+        char c = line[idx];
+        if (c == '/' || c == '\r') continue;
+        if (square == BOARD_SIZE * BOARD_SIZE) return false;
+        bool letter = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+        board.setTile(square % BOARD_SIZE, square / BOARD_SIZE, letter ? c : EMPTY);
+        ++square;
+    }
+    return square == BOARD_SIZE * BOARD_SIZE;
+}
+
+/**
+ * Writes a position the way readPosition reads it: the rack on one line
+ * and then the rows of the board, followed by an empty line
+ */
+void writePosition(std::ostream& output, const Board& board, const std::string& rack) {
+    output << rack << '\n';
+    for (std::size_t y = 0; y < BOARD_SIZE; ++y) {
+        for (std::size_t x = 0; x < BOARD_SIZE; ++x) {
+            char c = board.getTile(x, y);
+            output << (board.isBlank(x, y) ? (char) std::tolower(c) : c);
+        }
+        output << '\n';
+    }
+    output << '\n';
+}
+
+/**
+ * Writes a move as one line: word, x, y, direction and points,
+ * or a dash if there is no move
+ */
+void writeMove(std::ostream& output, const Move& move) {
+    if (move.word.empty()) { output << "-\n"; return; }
+    output << move.word << ' ' << move.anchorX << ' ' << move.anchorY << ' '
+           << (move.direction == VERTICAL ? "DOWN" : "RIGHT") << ' ' << move.points << '\n';
+}
+
 /**
  * Retrieves the point value of a word string
  * @param word
@@ -591,7 +875,7 @@ Board createBoardFromFile(const std::string filename) {
 std::size_t getPointValueOfWord(std::string word) {
     std::size_t _value = 0;
     for (std::size_t i = 0; i < word.length(); ++i)
-        _value += _letter_values[word[i]];
+        _value += letterValue(word[i]);
     return _value;
 }
 
@@ -603,71 +887,27 @@ std::size_t getPointValueOfWord(std::string word) {
  */
 std::size_t getPointValueOfMove(Move& move) {
     std::size_t _value = 0;
-    std::string _word = move.word;
-
-    // If bonus tiles are active, use the coordinates of each tile
-    // to determine if one of them is over a double or triple word.
-    #if (BONUS_TILES)
-        int double_flag = 0, triple_flag = 0;
-        std::size_t single_coord = (move.anchorY * BOARD_SIZE) + move.anchorX;
-        std::size_t pivot_coord = (move.pivotY * BOARD_SIZE) + move.pivotX;
-    #endif
+    std::size_t _word_multiplier = 1;
 
-    for (std::size_t i = 0; i < _word.length(); ++i) {
-        std::size_t letter_val = _letter_values[_word[i]];
+    // The coordinates of each tile determine if it is on a bonus tile
+    std::size_t single_coord = (move.anchorY * BOARD_SIZE) + move.anchorX;
+    std::size_t pivot_coord = (move.pivotY * BOARD_SIZE) + move.pivotX;
+    std::size_t step = (move.direction == VERTICAL) ? BOARD_SIZE : 1;
 
-        #if (BONUS_TILES)
-
-            // If the tile was placed before the move, no special tiles will be applied
-            if (single_coord == pivot_coord) {
-                _value += letter_val;
-                if (move.direction == VERTICAL) single_coord += 15;
-                if (move.direction == HORIZONTAL) ++single_coord;
-                continue;
-            }
-            // Searches map to see if the current tile location is on a bonus tile
-            try {
-                int special_move = bonus_tile_locations.at(single_coord);
-                
-                switch(special_move) {
-                    case (TRIPLE_LETTER):
-                        _value += letter_val << 1;
-                        break;
-                    case (DOUBLE_LETTER):
-                        _value += letter_val;
-                        break;
-                    case (TRIPLE_WORD):
-                        triple_flag++;
-                        break;
-                    case (DOUBLE_WORD):
-                        double_flag++;
-                        break;
-
-                }
-            }
-            // Simply catches the exception so the program can run
-            catch (std::out_of_range ex) {}
+    for (std::size_t i = 0; i < move.word.length(); ++i, single_coord += step) {
+        std::size_t letter_val = letterValue(move.word[i]);
 
+        // If the tile was placed before the move, no special tiles will be applied
+        if (single_coord == pivot_coord) {
             _value += letter_val;
+            continue;
+        }
 
-        #else
-            _value += letter_val;
-        #endif
-        
-        // Adjust single coordinate for next iteration based
-        // on the direction of the move
-        #if (BONUS_TILES)
-            if (move.direction == VERTICAL) single_coord += 15;
-            if (move.direction == HORIZONTAL) ++single_coord;
-        #endif
+        _value += letter_val * letterMultiplier(single_coord);
+        _word_multiplier *= wordMultiplier(single_coord);
     }
 
-    // Checks if the double or triple word flags are up
-    #if (BONUS_TILES)
-        _value *= (std::size_t) pow(2, double_flag);
-        _value *= (std::size_t) pow(3, triple_flag);
-    #endif
-
+    _value *= _word_multiplier;
     move.points += _value;
     return _value;
 }
@@ -682,7 +922,7 @@ std::size_t getPointValueOfMove(Move& move) {
  * @return Number of neighbors the tile has relative
  *         to the scrabble board
  */
-int getEmptyNeighbors(const Board board, const Tile tile) {
+int getEmptyNeighbors(const Board& board, const Tile& tile) {
     int neighbors = 0;
     
     // Check if left neighbor empty
@@ -708,10 +948,10 @@ int getEmptyNeighbors(const Board board, const Tile tile) {
  * Method for debugging
  * Prints board to console
  */ 
-void printBoardValues(const Board board) {
+void printBoardValues(const Board& board) {
     for (std::size_t y = 0; y < BOARD_SIZE; ++y) {
         for (std::size_t x = 0; x < BOARD_SIZE; ++x) {
-            std::cout << board.tiles[x][y].probability << '\t';
+            std::cout << board.tile(x, y).probability << '\t';
         }
         std::cout << '\n';
     }
@@ -1,7 +1,9 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <deque>
 #include <fstream>
 #include <iostream>
@@ -11,16 +13,25 @@
 #include <unordered_set>
 #include <vector>
 
+#include "bitboard.h"
+#include "stats.h"
 #include "math.h"
 
 // Special scrabble characters
 #define EMPTY '-'
 #define WILDCARD ' '
+#define WILDCARD_ALIAS '?' // Also a blank in a rack, easier to type than a space
 #define OUT_OF_BOUNDS '~'
 
 // Width and height of the board
 #define BOARD_SIZE 15
 
+// Number of squares on the board
+#define BOARD_AREA (BOARD_SIZE * BOARD_SIZE)
+
+// Mask with a bit set for each of the 26 letters (A = bit 0)
+#define ALL_LETTERS 0x03FFFFFFu
+
 // Area for which the probability
 #define PROB_CALC_SIZE 2
 #define PROB_ARRAY_SIZE 5
@@ -33,6 +44,12 @@ constexpr int PROB_CALC_AREA_DIRECTION = (PROB_CALC_SIZE + 1) << 2;
 // Maximum amount of points a scrabble letter can have
 #define MAX_LETTER_POINTS 10
 
+// Number of letters in a player's hand
+#define RACK_SIZE 7
+
+// Bonus points for using every letter in the hand in one move
+#define BINGO_BONUS 50
+
 /**
  * Direction that the word is placed
  * The word can either go vertically down
@@ -58,45 +75,75 @@ constexpr int PROB_CALC_AREA_DIRECTION = (PROB_CALC_SIZE + 1) << 2;
 #define BRUTE_FORCE 1 
 
 // Define method for searching for a word
-#define METHOD PROBABILISTIC
+#ifndef METHOD
+    #define METHOD BRUTE_FORCE
+#endif
 
 // File for the words in the scrabble dictionary
 #define DICTIONARY "../scrabble_dictionary.txt"
 
+// Compiled dictionary image made by the compile_dictionary program
+#define DICTIONARY_IMAGE "scrabble_dictionary.gaddag"
+
+/**
+ * Scrabble point values of the letters A-Z
+ */
+constexpr int LETTER_POINTS[26] = {
+    1, 3, 3, 2, 1, 4, 2, 4, 1, 8, 5, 1, 3, // A - M
+    1, 1, 3, 10, 1, 1, 1, 1, 4, 4, 8, 4, 10 // N - Z
+};
+
 /**
- * Maps the letters to their scrabble point values
+ * Number of tiles of each letter A-Z in a full bag
  */
-static std::unordered_map<char, int> _letter_values = {
-    {EMPTY, -1},   // An empty space is simply a negative value for consistency
-    {WILDCARD, 0}, // A wildcard can be any letter
-    {'A', 1},      // A = 1 point
-    {'B', 3},      // B = 3 points
-    {'C', 3},      // C = 3 points
-    {'D', 2},      // D = 2 points
-    {'E', 1},      // E = 1 point
-    {'F', 4},      // F = 4 points
-    {'G', 2},      // G = 2 points
-    {'H', 4},      // H = 4 points
-    {'I', 1},      // I = 1 point
-    {'J', 8},      // J = 8 points
-    {'K', 5},      // K = 5 points
-    {'L', 1},      // L = 1 point
-    {'M', 3},      // M = 3 points
-    {'N', 2},      // N = 1 point
-    {'O', 1},      // O = 1 point
-    {'P', 3},      // P = 3 points
-    {'Q', 10},     // Q = 10 points
-    {'R', 1},      // R = 1 point
-    {'S', 1},      // S = 1 point
-    {'T', 1},      // T = 1 point
-    {'U', 1},      // U = 1 point
-    {'V', 4},      // V = 4 points
-    {'W', 4},      // W = 4 points
-    {'X', 8},      // X = 8 points
-    {'Y', 4},      // Y = 4 points
-    {'Z', 10},     // Z = 10 points
+constexpr int LETTER_TILES[26] = {
+    9, 2, 2, 4, 12, 2, 3, 2, 9, 1, 1, 4, 2, // A - M
+    6, 8, 2, 1, 6, 4, 6, 4, 2, 2, 1, 2, 1 // N - Z
 };
 
+// Number of blank tiles in a full bag
+#define BLANK_TILES 2
+
+/**
+ * Retrieves the point value of a letter
+ * @param letter
+ *          Uppercase letter, an empty space or a wildcard
+ * @return Point value of the letter, 0 if it isn't a letter
+ */
+constexpr int letterValue(char letter) {
+    return (letter >= 'A' && letter <= 'Z') ? LETTER_POINTS[letter - 'A'] : 0;
+}
+
+/**
+ * One xor-shift-multiply step of the splitmix64 finalizer
+ */
+constexpr std::uint64_t mixStep(std::uint64_t z, int shift, std::uint64_t multiplier) {
+    return (z ^ (z >> shift)) * multiplier;
+}
+
+/**
+ * splitmix64: a well spread pseudo-random number for every input
+ */
+constexpr std::uint64_t splitMix64(std::uint64_t z) {
+    return mixStep(mixStep(mixStep(z + 0x9E3779B97F4A7C15ull, 30, 0xBF58476D1CE4E5B9ull),
+                           27, 0x94D049BB133111EBull), 31, 1);
+}
+
+/**
+ * Zobrist key of a tile on a square: a fixed pseudo-random number for
+ * each square and each letter, as a real tile or as a blank. The keys
+ * are computed when they are needed, so there is no table to set up.
+ * @param square
+ *          Index of the square (y * BOARD_SIZE + x)
+ * @param letter
+ *          Uppercase letter of the tile
+ * @param blank
+ *          Whether or not the tile is a blank
+ */
+constexpr std::uint64_t zobristKey(int square, char letter, bool blank) {
+    return splitMix64((std::uint64_t) (square * 52 + (letter - 'A') + (blank ? 26 : 0)));
+}
+
 /**
  * If the bonus tiles are being taken into account,
  * the locations for them are defined.
@@ -106,94 +153,54 @@ static std::unordered_map<char, int> _letter_values = {
 #define TRIPLE_WORD 3
 #define DOUBLE_WORD 4
 
-#if (BONUS_TILES)
-    
-    /**
-     * The x-coordinate can be determined by finding modular of
-     * the location with respect to 15 (location % 15)
-     * 
-     * The y-coordinate can be calculated by finding the integer
-     * value of the quotient with respect to 15 ((int) location / 15)
-     */
+/**
+ * Layout of the bonus tiles, one character per square in the
+ * order of the square index (y * BOARD_SIZE + x)
+ *      T = Triple word, D = Double word (the middle square is one too)
+ *      t = Triple letter, d = Double letter
+ */
+constexpr char BONUS_LAYOUT[BOARD_AREA + 1] =
+    "T..d...T...d..T"
+    ".D...t...t...D."
+    "..D...d.d...D.."
+    "d..D...d...D..d"
+    "....D.....D...."
+    ".t...t...t...t."
+    "..d...d.d...d.."
+    "T..d...D...d..T"
+    "..d...d.d...d.."
+    ".t...t...t...t."
+    "....D.....D...."
+    "d..D...d...D..d"
+    "..D...d.d...D.."
+    ".D...t...t...D."
+    "T..d...T...d..T";
 
-    static std::unordered_map<std::size_t, int> bonus_tile_locations = {
-        /**
-         * Triple letter locations on the board
-         */
-        {20, TRIPLE_LETTER},
-        {24, TRIPLE_LETTER},
-        {76, TRIPLE_LETTER},
-        {80, TRIPLE_LETTER},
-        {84, TRIPLE_LETTER},
-        {88, TRIPLE_LETTER},
-        {136, TRIPLE_LETTER},
-        {140, TRIPLE_LETTER},
-        {144, TRIPLE_LETTER},
-        {148, TRIPLE_LETTER},
-        {200, TRIPLE_LETTER},
-        {204, TRIPLE_LETTER},
-
-        /**
-         * Double letter locatons on the board
-         */
-        {3, DOUBLE_LETTER},
-        {11, DOUBLE_LETTER},
-        {36, DOUBLE_LETTER},
-        {38, DOUBLE_LETTER},
-        {45, DOUBLE_LETTER},
-        {52, DOUBLE_LETTER},
-        {59, DOUBLE_LETTER},
-        {92, DOUBLE_LETTER},
-        {96, DOUBLE_LETTER},
-        {98, DOUBLE_LETTER},
-        {102, DOUBLE_LETTER},
-        {108, DOUBLE_LETTER},
-        {116, DOUBLE_LETTER},
-        {122, DOUBLE_LETTER},
-        {126, DOUBLE_LETTER},
-        {128, DOUBLE_LETTER},
-        {132, DOUBLE_LETTER},
-        {165, DOUBLE_LETTER},
-        {172, DOUBLE_LETTER},
-        {179, DOUBLE_LETTER},
-        {186, DOUBLE_LETTER},
-        {188, DOUBLE_LETTER},
-        {213, DOUBLE_LETTER},
-        {221, DOUBLE_LETTER},
-
-        /**
-         * Triple word locations
-         */
-        {0, TRIPLE_WORD},
-        {7, TRIPLE_WORD},
-        {14, TRIPLE_WORD},
-        {105, TRIPLE_WORD},
-        {119, TRIPLE_WORD},
-        {210, TRIPLE_WORD},
-        {217, TRIPLE_WORD},
-        {224, TRIPLE_WORD},
-
-        /**
-         * Double word locations
-         */
-        {16, DOUBLE_WORD},
-        {28, DOUBLE_WORD},
-        {32, DOUBLE_WORD},
-        {42, DOUBLE_WORD},
-        {48, DOUBLE_WORD},
-        {56, DOUBLE_WORD},
-        {64, DOUBLE_WORD},
-        {70, DOUBLE_WORD},
-        {154, DOUBLE_WORD},
-        {160, DOUBLE_WORD},
-        {168, DOUBLE_WORD},
-        {176, DOUBLE_WORD},
-        {182, DOUBLE_WORD},
-        {192, DOUBLE_WORD},
-        {196, DOUBLE_WORD},
-        {208, DOUBLE_WORD},
-    };
-#endif
+/**
+ * Retrieves the bonus on the square with the given index
+ * @return TRIPLE_LETTER, DOUBLE_LETTER, TRIPLE_WORD, DOUBLE_WORD or 0 for no bonus
+ */
+constexpr int bonusTile(std::size_t idx) {
+    return (!BONUS_TILES || idx >= BOARD_AREA) ? 0 :
+           (BONUS_LAYOUT[idx] == 't') ? TRIPLE_LETTER :
+           (BONUS_LAYOUT[idx] == 'd') ? DOUBLE_LETTER :
+           (BONUS_LAYOUT[idx] == 'T') ? TRIPLE_WORD :
+           (BONUS_LAYOUT[idx] == 'D') ? DOUBLE_WORD : 0;
+}
+
+/**
+ * Multiplier applied to the letter placed on the square with the given index
+ */
+constexpr int letterMultiplier(std::size_t idx) {
+    return (bonusTile(idx) == TRIPLE_LETTER) ? 3 : (bonusTile(idx) == DOUBLE_LETTER) ? 2 : 1;
+}
+
+/**
+ * Multiplier applied to a word with a letter placed on the square with the given index
+ */
+constexpr int wordMultiplier(std::size_t idx) {
+    return (bonusTile(idx) == TRIPLE_WORD) ? 3 : (bonusTile(idx) == DOUBLE_WORD) ? 2 : 1;
+}
 
 
 
@@ -228,6 +235,62 @@ typedef struct Tile {
     }
 } tile;
 
+/**
+ * Letters of a move, kept inline so that copying or building a move
+ * never allocates. No word is longer than a line of the board.
+ * Reads like the std::string it replaced.
+ */
+typedef struct MoveWord {
+    char letters[BOARD_SIZE];      // Letters of the word, not terminated
+    std::uint8_t count;            // Number of letters
+
+    /**
+     * MoveWord default constructor
+     * Defaults: No letters
+     */
+    MoveWord() : count(0) {};
+
+    MoveWord(const char* text) : count(0) { assign(text, text + std::char_traits<char>::length(text)); }
+    MoveWord(const std::string& text) : count(0) { assign(text.data(), text.data() + text.length()); }
+
+    /**
+     * Replaces the letters, anything past the length of a line is dropped
+     */
+    void assign(const char* first, const char* last) {
+        count = (std::uint8_t) std::min<std::ptrdiff_t>(last - first, BOARD_SIZE);
+        std::copy(first, first + count, letters);
+    }
+
+    bool empty() const { return count == 0; }
+    std::size_t length() const { return count; }
+    std::size_t size() const { return count; }
+    char operator[](std::size_t idx) const { return letters[idx]; }
+    char& operator[](std::size_t idx) { return letters[idx]; }
+    const char* begin() const { return letters; }
+    const char* end() const { return letters + count; }
+
+    /**
+     * Position of the first copy of a letter at or after start, std::string::npos if there is none
+     */
+    std::size_t find(char letter, std::size_t start = 0) const {
+        for (std::size_t idx = start; idx < count; ++idx) {
+            if (letters[idx] == letter) return idx;
+        }
+        return std::string::npos;
+    }
+
+    std::string str() const { return std::string(letters, count); }
+
+    bool operator==(const MoveWord& other) const {
+        return count == other.count && std::equal(letters, letters + count, other.letters);
+    }
+    bool operator!=(const MoveWord& other) const { return !(*this == other); }
+} move_word;
+
+inline std::ostream& operator<<(std::ostream& out, const MoveWord& word) {
+    return out.write(word.letters, word.count);
+}
+
 /**
  * Defines a potential move on the board.
  * The move consists of a sequence of letters (word),
@@ -236,8 +299,9 @@ typedef struct Tile {
  * move, which are the coordinates of the first letter.
  */
 typedef struct Move {
-    std::string word;              // Sequence of letters for move
+    MoveWord word;                 // Sequence of letters for move
     std::size_t points;                    // Points for word
+    float leave;                   // Equity of the tiles left on the rack, 0 without a leave table
     int anchorX, anchorY;          // Anchor point for the word
     int direction;                 // Direction for the move (down or right)
     std::size_t pivotX, pivotY;    // Tile for the move to pivot off of
@@ -247,16 +311,23 @@ typedef struct Move {
      * Defaults:
      *      Word = "", Indicates that there is no move
      *      Points = 0, Indicates a null move has no points
+     *      Leave = 0, Nothing is known about the tiles left on the rack
      *      anchorX, anchorY = BOARD_SIZE, Indicates the beginning of the word
      *      Direction = NO_DIRECTION, A null move has no direction
      */
-    Move() : word(""), points(0), anchorX(BOARD_SIZE), anchorY(BOARD_SIZE), direction(NO_DIRECTION) {};
+    Move() : word(), points(0), leave(0), anchorX(BOARD_SIZE), anchorY(BOARD_SIZE), direction(NO_DIRECTION),
+        pivotX(BOARD_SIZE), pivotY(BOARD_SIZE) {};
 
     /**
      * Move parameterized constructor
      */
-    Move(std::string w, int p, int aX, int aY, int dir) : 
-        word(w), points(p), anchorX(aX), anchorY(aY), direction(dir) {};
+    Move(const std::string& w, int p, int aX, int aY, int dir) : 
+        word(w), points(p), leave(0), anchorX(aX), anchorY(aY), direction(dir), pivotX(BOARD_SIZE), pivotY(BOARD_SIZE) {};
+
+    /**
+     * Points of the move plus the equity of its leave, what moves are ranked by
+     */
+    double equity() const { return (double) points + leave; }
 
     /**
      * Prints out the move in the given format:
@@ -270,18 +341,100 @@ typedef struct Move {
     }
 } move;
 
+class Gaddag;
+class LeaveTable;
+
 /**
- * A board is a double array consisting of tiles.
- * In reality, the board is 15x15.
+ * A board is a 15x15 grid of letters.
+ * The letters are stored twice, once row by row and once column
+ * by column, so both a row and a column can be walked as one
+ * contiguous line. Which squares hold a tile is also kept as a
+ * bitboard for each layout, so neighbor and anchor queries are
+ * a few shifts and masks.
  */
 typedef struct Board {
 
     /**
-     * Board initialized to a 15x15 tile array consisting of
-     * empty tiles. The board can be created using the
-     * "createBoardFromFile" method.
+     * Letters on the board, EMPTY if there is no tile
+     * letters:    by row, index y * BOARD_SIZE + x
+     * transposed: by column, index x * BOARD_SIZE + y
+     * The board can be created using the "createBoardFromFile" method.
+     */
+    char letters[BOARD_AREA];
+    char transposed[BOARD_AREA];
+
+    // Squares with a tile, by row and by column
+    Bitboard occupied;
+    Bitboard occupied_transposed;
+
+    // Squares with a blank tile, by row. Its letter is stored like any other, but it has no points
+    Bitboard blanks;
+
+    // Zobrist hash of the tiles: the xor of the zobristKey of every tile on the board
+    std::uint64_t hash;
+
+    #if (METHOD == PROBABILISTIC)
+        // Probability that a word can be made on each square, by row
+        double probabilities[BOARD_AREA];
+    #endif
+
+    /**
+     * Cross-checks for each square, indexed by the direction of the
+     * move (VERTICAL or HORIZONTAL) and then by "lineIndex", so the
+     * squares of a line in the direction of the move are contiguous.
+     * cross_checks: letters (bit 0 = A) that can be placed on the square
+     *               without making an invalid perpendicular word
+     * cross_points: points of the perpendicular letters next to the
+     *               square, -1 if placing a letter makes no perpendicular word
+     * They are filled in by "computeCrossChecks", which needs to be called
+     * again if the letters are changed without "apply" or "undo".
      */
-    Tile tiles[BOARD_SIZE][BOARD_SIZE];
+    std::uint32_t cross_checks[2][BOARD_AREA];
+    std::int16_t cross_points[2][BOARD_AREA];
+    bool cross_checks_ready;
+
+    // Dictionary the cross-checks were computed with
+    const Gaddag* gaddag;
+
+    // Whether or not the probabilities of the tiles are up to date
+    bool probabilities_ready;
+
+    /**
+     * Squares (y * BOARD_SIZE + x) of the tiles placed by a move
+     */
+    typedef struct Placement {
+        std::uint8_t count;
+        std::uint8_t squares[RACK_SIZE];
+    } placement;
+
+    // Tiles placed by each applied move, most recent last
+    std::vector<Placement> history;
+
+    /**
+     * Board default constructor
+     * Every square is empty and allows any letter until the
+     * cross-checks are computed
+     */
+    Board() : hash(0), cross_checks_ready(false), gaddag(nullptr), probabilities_ready(false) {
+        for (int idx = 0; idx < BOARD_AREA; ++idx) {
+            letters[idx] = transposed[idx] = EMPTY;
+            #if (METHOD == PROBABILISTIC)
+                probabilities[idx] = 0.0;
+            #endif
+            for (int direction = 0; direction < 2; ++direction) {
+                cross_checks[direction][idx] = ALL_LETTERS;
+                cross_points[direction][idx] = -1;
+            }
+        }
+    };
+
+    /**
+     * Index of a square within the lines of the given direction:
+     * by row for HORIZONTAL and by column for VERTICAL
+     */
+    static int lineIndex(int direction, std::size_t x, std::size_t y) {
+        return (direction == HORIZONTAL) ? (int) (y * BOARD_SIZE + x) : (int) (x * BOARD_SIZE + y);
+    }
 
     /**
      * Returns the letter of the tile at the given coordinates
@@ -294,10 +447,99 @@ typedef struct Board {
      *         OUT_OF_BOUNDS if coordinates are outside of board
      */
     char getTile(std::size_t x, std::size_t y) const {
-        if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE)
+        if (x >= BOARD_SIZE || y >= BOARD_SIZE)
             return OUT_OF_BOUNDS;
-        return tiles[x][y].letter; 
+        return letters[y * BOARD_SIZE + x]; 
     }
+
+    /**
+     * Puts a letter (or EMPTY) on the square and keeps both
+     * layouts, the occupancy and the hash up to date.
+     * A lowercase letter is a blank tile standing for that letter.
+     */
+    void setTile(std::size_t x, std::size_t y, char letter) {
+        int row = (int) (y * BOARD_SIZE + x), col = (int) (x * BOARD_SIZE + y);
+        if (letters[row] != EMPTY) hash ^= zobristKey(row, letters[row], blanks.test(row));
+
+        if (letter >= 'a' && letter <= 'z') { letter = (char) (letter - 'a' + 'A'); blanks.set(row); }
+        else blanks.clear(row);
+        letters[row] = transposed[col] = letter;
+        if (letter != EMPTY) hash ^= zobristKey(row, letter, blanks.test(row));
+        if (letter == EMPTY) { occupied.clear(row); occupied_transposed.clear(col); }
+        else { occupied.set(row); occupied_transposed.set(col); }
+    }
+
+    /**
+     * Zobrist hash of the tiles computed from every square, "hash"
+     * should always be equal to it
+     */
+    std::uint64_t computeHash() const {
+        std::uint64_t result = 0;
+        for (int idx = 0; idx < BOARD_AREA; ++idx) {
+            if (letters[idx] != EMPTY) result ^= zobristKey(idx, letters[idx], blanks.test(idx));
+        }
+        return result;
+    }
+
+    /**
+     * Whether or not the tile at the given coordinates is a blank
+     */
+    bool isBlank(std::size_t x, std::size_t y) const {
+        return x < BOARD_SIZE && y < BOARD_SIZE && blanks.test((int) (y * BOARD_SIZE + x));
+    }
+
+    /**
+     * Point value of the tile at the given coordinates, 0 for a blank or no tile
+     */
+    int tilePoints(std::size_t x, std::size_t y) const {
+        return isBlank(x, y) ? 0 : letterValue(getTile(x, y));
+    }
+
+    /**
+     * Tile at the given coordinates with its point value and probability
+     */
+    Tile tile(std::size_t x, std::size_t y) const {
+        Tile t;
+        t.letter = letters[y * BOARD_SIZE + x];
+        t.points = tilePoints(x, y);
+        t.x = x;
+        t.y = y;
+        #if (METHOD == PROBABILISTIC)
+            t.probability = probabilities[y * BOARD_SIZE + x];
+        #endif
+        return t;
+    }
+
+    /**
+     * Empty squares next to a tile, where every move has to place at
+     * least one tile. Given the transposed occupancy, the anchors come
+     * back transposed as well.
+     */
+    static Bitboard anchors(const Bitboard& tiles) {
+        return tiles.neighbors() & ~tiles;
+    }
+
+    /**
+     * Places the letters of the move on the empty squares it covers,
+     * lowercase letters as blank tiles.
+     * Only the squares around the new tiles are updated: their
+     * cross-checks (if computed) and the probabilities (if computed).
+     * @param move
+     *          Move to play, the word includes letters already on the board
+     * @return True if the move was placed,
+     *         False if it leaves the board, doesn't match the letters
+     *         already there, or places no tiles (the board is unchanged)
+     */
+    bool apply(const Move& move);
+
+    /**
+     * Removes the tiles placed by the most recently applied move
+     * @return False if there is no move to undo
+     */
+    bool undo();
+
+private:
+    void updateAround(std::size_t x, std::size_t y);
 } board;
 
 
@@ -313,33 +555,69 @@ std::unordered_set<std::string> initializeWordSet(); // Method to initialize thi
 
 Board createBoardFromFile(const std::string filename);
 
-std::vector<std::string> getWordsOnBoard(const Board board);
+bool readBoard(std::istream& input, Board& board);
+
+bool readPosition(std::istream& input, Board& board, std::string& rack);
+
+bool parsePosition(const std::string& line, Board& board, std::string& rack);
+
+void writePosition(std::ostream& output, const Board& board, const std::string& rack);
+
+void writeMove(std::ostream& output, const Move& move);
+
+void computeCrossCheck(Board& board, const Gaddag& gaddag, std::size_t x, std::size_t y);
 
-int getEmptyNeighbors(const Board board, const Tile tile);
+void computeCrossChecks(Board& board, const Gaddag& gaddag);
 
-void printBoardValues(const Board board);
+std::vector<std::string> getWordsOnBoard(const Board& board);
 
-bool boardIsEmpty(const Board board);
+int getEmptyNeighbors(const Board& board, const Tile& tile);
 
-std::vector<std::string> getPossibleWords(std::vector<char> letters, bool four_or_more);
+void printBoardValues(const Board& board);
 
+bool boardIsEmpty(const Board& board);
+
+bool canMakeWord(const std::vector<char>& letters, const std::string& word);
+
+std::vector<std::string> getPossibleWords(std::vector<char> letters);
+
+class AnagramIndex;
+
+std::vector<std::string> getPossibleWords(const AnagramIndex& index, std::vector<char> letters);
+
+/**
+ * Finds the best word using a solver that is created
+ * the first time it is needed and kept for later calls
+ */
 Move findBestWord(Board& board, std::string letters);
 
+/**
+ * Finds the best k moves using the same shared solver
+ */
+std::vector<Move> findTopMoves(Board& board, std::string letters, std::size_t k);
+
+std::vector<Move> findTopMoves(Board& board, std::string letters, std::size_t k, const Gaddag& gaddag,
+                               const LeaveTable* leaves = nullptr);
+
 std::size_t getPointValueOfWord(std::string word);
 
 std::size_t getPointValueOfMove(Move& move);
 
 #if (METHOD == PROBABILISTIC)
 
-    int getBestDirection(const Board board, const Tile tile);
+    int getBestDirection(const Board& board, const Tile& tile);
 
     void calcTileProbability(Board& board, Tile& tile);
 
     void getProbabilities(Board& board);
 
+    void updateProbabilitiesAround(Board& board, std::size_t x, std::size_t y);
+
     Tile* getHighestProbabilities(Board& board);
 
-    bool isPossibleMove(const Board board, std::unordered_set<std::string> scrabble_words, Move& move);
+    bool isPossibleMove(const Board& board, Move& move);
+
+    Move findBestWord(Board& board, std::string letters, const AnagramIndex& index, QueryStats* stats = nullptr);
 
     template <typename T, std::size_t N>
     void insert(T (&arr)[N], T item, int idx) {
@@ -357,4 +635,11 @@ std::size_t getPointValueOfMove(Move& move);
 
 #endif /* METHOD */
 
+#if (METHOD == BRUTE_FORCE)
+
+    Move findBestWord(Board& board, std::string letters, const Gaddag& gaddag, QueryStats* stats = nullptr,
+                      const LeaveTable* leaves = nullptr);
+
+#endif /* METHOD */
+
 #endif /* BOARD_H */
\ No newline at end of file
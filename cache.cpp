@@ -0,0 +1,93 @@
+#include "cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+/**
+ * Folds a 64-bit word into the hash
+ */
+static std::uint64_t mixKey(std::uint64_t hash, std::uint64_t word) {
+    hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+    return hash ^ (hash >> 33);
+}
+
+std::uint64_t positionKey(const Board& board, const std::string& rack) {
+    // The board is already hashed as its tiles are placed
+    std::uint64_t hash = board.hash;
+
+    std::string sorted;
+    for (char c : rack) sorted += (c == WILDCARD) ? WILDCARD_ALIAS : (char) std::toupper(c);
+    std::sort(sorted.begin(), sorted.end());
+    for (std::size_t idx = 0; idx < sorted.length(); idx += 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, sorted.data() + idx, std::min<std::size_t>(8, sorted.length() - idx));
+        hash = mixKey(hash, word);
+    }
+    return mixKey(hash, sorted.length());
+}
+
+ResultCache::ResultCache(std::size_t bytes) :
+    _shard_capacity(bytes / (sizeof(Entry) + CACHE_INDEX_BYTES) / CACHE_SHARDS) {
+    for (Shard& s : _shards) {
+        s.slots.reserve(_shard_capacity);
+        s.index.reserve(_shard_capacity);
+    }
+}
+
+bool ResultCache::find(std::uint64_t key, Move& move) {
+    Shard& s = shardOf(key);
+    std::lock_guard<std::mutex> guard(s.lock);
+
+    auto found = s.index.find(key);
+    if (found == s.index.end()) { ++s.misses; return false; }
+
+    Entry& e = s.slots[found->second];
+    e.referenced = true;
+    move = e.move;
+    ++s.hits;
+    return true;
+}
+
+void ResultCache::insert(std::uint64_t key, const Move& move) {
+    if (_shard_capacity == 0) return;
+    Shard& s = shardOf(key);
+    std::lock_guard<std::mutex> guard(s.lock);
+
+    auto found = s.index.find(key);
+    if (found != s.index.end()) {
+        s.slots[found->second].move = move;
+        return;
+    }
+
+    if (s.slots.size() < _shard_capacity) {
+        s.index[key] = (std::uint32_t) s.slots.size();
+        s.slots.push_back(Entry{key, move, false});
+        return;
+    }
+
+    // Every referenced slot the hand passes gets a second chance
+    while (s.slots[s.hand].referenced) {
+        s.slots[s.hand].referenced = false;
+        s.hand = (s.hand + 1) % _shard_capacity;
+    }
+
+    Entry& victim = s.slots[s.hand];
+    s.index.erase(victim.key);
+    victim.key = key;
+    victim.move = move;
+    s.index[key] = (std::uint32_t) s.hand;
+    s.hand = (s.hand + 1) % _shard_capacity;
+    ++s.evictions;
+}
+
+CacheStats ResultCache::stats() const {
+    CacheStats total;
+    for (const Shard& s : _shards) {
+        std::lock_guard<std::mutex> guard(s.lock);
+        total.hits += s.hits;
+        total.misses += s.misses;
+        total.evictions += s.evictions;
+        total.entries += s.slots.size();
+    }
+    return total;
+}
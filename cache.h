@@ -0,0 +1,105 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "board.h"
+
+// Independently locked parts of a cache, so threads rarely wait on each other
+#define CACHE_SHARDS 16
+
+// Memory cap of the cache used by the batch and daemon modes
+#define CACHE_BYTES (64u << 20)
+
+// Estimated memory used by the index for each cached result, on top of the result itself
+#define CACHE_INDEX_BYTES 48
+
+/**
+ * 64-bit hash of a position: the Zobrist hash of the board combined with
+ * the sorted letters of the rack, so the order of the rack doesn't matter
+ */
+std::uint64_t positionKey(const Board& board, const std::string& rack);
+
+/**
+ * Counters of a cache, added up over every shard
+ */
+typedef struct CacheStats {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t evictions;
+    std::size_t entries;
+
+    CacheStats() : hits(0), misses(0), evictions(0), entries(0) {};
+} cache_stats;
+
+/**
+ * Bounded, thread-safe cache of the best move of positions, keyed by
+ * positionKey. Only the key is kept, not the position, so two positions
+ * with the same 64-bit hash share a result.
+ *
+ * The cache is split into shards by key, each with its own lock and a
+ * fixed number of slots. A full shard evicts with the CLOCK algorithm:
+ * a hit marks the slot as referenced, and the hand sweeping the slots
+ * gives every referenced slot a second chance before replacing the
+ * first one that wasn't used since the hand last went past it.
+ */
+class ResultCache {
+public:
+    /**
+     * @param bytes
+     *          Memory cap, turned into a fixed number of slots
+     */
+    explicit ResultCache(std::size_t bytes);
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    /**
+     * Looks up the result of a position
+     * @return True if the result was cached, and then it is copied to move
+     */
+    bool find(std::uint64_t key, Move& move);
+
+    /**
+     * Stores the result of a position, evicting another one if the shard is full
+     */
+    void insert(std::uint64_t key, const Move& move);
+
+    /**
+     * Hits, misses, evictions and the number of results cached
+     */
+    CacheStats stats() const;
+
+    /**
+     * Most results the cache holds
+     */
+    std::size_t capacity() const { return _shard_capacity * CACHE_SHARDS; }
+
+private:
+    typedef struct Entry {
+        std::uint64_t key;
+        Move move;
+        bool referenced;
+    } entry;
+
+    typedef struct Shard {
+        mutable std::mutex lock;
+        std::vector<Entry> slots;
+        std::unordered_map<std::uint64_t, std::uint32_t> index;
+        std::size_t hand;
+        std::uint64_t hits, misses, evictions;
+
+        Shard() : hand(0), hits(0), misses(0), evictions(0) {};
+    } shard;
+
+    Shard& shardOf(std::uint64_t key) { return _shards[key % CACHE_SHARDS]; }
+
+    std::size_t _shard_capacity;
+    Shard _shards[CACHE_SHARDS];
+};
+
+#endif /* CACHE_H */
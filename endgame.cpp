@@ -0,0 +1,233 @@
+#include "endgame.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "game.h"
+#include "simulate.h"
+
+EndgameSolver::EndgameSolver(const Solver& solver, std::size_t table_bits) :
+    _solver(solver), _generator(solver.gaddag()), _table(table_bits ? (std::size_t) 1 << table_bits : 0),
+    _table_mask(table_bits ? ((std::uint64_t) 1 << table_bits) - 1 : 0),
+    _board(nullptr), _nodes(0), _max_nodes(0), _timed(false), _interruptible(false), _stopped(false), _horizon(false) {}
+
+EndgameResult EndgameSolver::solve(Board& board, const std::string& rack, const std::string& opponent,
+                                   std::size_t milliseconds, std::uint64_t max_nodes) {
+    auto start = std::chrono::steady_clock::now();
+    if (!board.cross_checks_ready)
+        computeCrossChecks(board, _solver.gaddag());
+
+    _board = &board;
+    _racks[0] = _racks[1] = "";
+    for (char c : rack) _racks[0] += (c == WILDCARD) ? WILDCARD_ALIAS : (char) std::toupper(c);
+    for (char c : opponent) _racks[1] += (c == WILDCARD) ? WILDCARD_ALIAS : (char) std::toupper(c);
+
+    std::fill(_table.begin(), _table.end(), Entry());
+    _nodes = 0;
+    _max_nodes = max_nodes;
+    _timed = milliseconds > 0;
+    _deadline = start + std::chrono::milliseconds(milliseconds);
+    _interruptible = false;
+    _stopped = false;
+
+    EndgameResult result;
+    for (int depth = 1; depth <= ENDGAME_MAX_DEPTH; ++depth) {
+        std::vector<Move> line;
+        _horizon = false;
+        int value = search(depth, -INT_MAX, INT_MAX, 0, false, line);
+        if (_stopped) break;
+
+        result.spread = value;
+        result.line = line;
+        result.depth = depth;
+        _interruptible = true;
+        if (!_horizon) { result.solved = true; break; }
+    }
+
+    result.nodes = _nodes;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    _board = nullptr;
+    return result;
+}
+
+/**
+ * Transposition table key: the board, the tiles on each rack
+ * (in any order) and whether the last turn was a pass
+ */
+std::uint64_t EndgameSolver::key(int side, bool passed) const {
+    // Kept clear of the inputs of the board's Zobrist keys
+    const std::uint64_t RACK_KEYS = 1u << 20;
+
+    std::uint64_t hash = _board->hash ^ splitMix64(RACK_KEYS - 1 - (std::uint64_t) passed - 2 * (std::uint64_t) side);
+    for (int player = 0; player < 2; ++player) {
+        const std::string& rack = _racks[player ^ side];
+        for (std::size_t idx = 0; idx < rack.size(); ++idx) {
+            std::uint64_t copy = (std::uint64_t) std::count(rack.begin(), rack.begin() + idx, rack[idx]);
+            hash ^= splitMix64(RACK_KEYS + ((std::uint64_t) player << 12) + ((std::uint64_t) (unsigned char) rack[idx] << 3) + copy);
+        }
+    }
+    return hash;
+}
+
+bool EndgameSolver::outOfBudget() {
+    if (_max_nodes && _nodes >= _max_nodes) return true;
+    return _timed && std::chrono::steady_clock::now() >= _deadline;
+}
+
+/**
+ * Rebuilds the best line from a position by playing the best move of each exact entry
+ * @param depth
+ *          Plies the line may take
+ * @param passed
+ *          Whether or not the opponent passed on the last turn
+ * @param line
+ *          The moves are appended to it
+ */
+void EndgameSolver::followTable(int depth, int side, bool passed, std::vector<Move>& line) {
+    if (depth == 0 || _table.empty()) return;
+    std::uint64_t hash = key(side, passed);
+    const Entry& slot = _table[hash & _table_mask];
+    if (slot.key != hash || slot.bound != EXACT) return;
+
+    Move m = slot.best;
+    line.push_back(m);
+    if (m.word.empty()) {
+        // Two passes in a row end the game
+        if (!passed) followTable(depth - 1, side ^ 1, true, line);
+        return;
+    }
+
+    std::string& rack = _racks[side];
+    std::string saved = rack;
+    for (char tile : tilesPlaced(*_board, m)) {
+        std::size_t at = rack.find(tile);
+        if (at == std::string::npos) { rack = saved; line.pop_back(); return; }
+        rack.erase(at, 1);
+    }
+    _board->apply(m);
+    if (!rack.empty()) followTable(depth - 1, side ^ 1, false, line);
+    _board->undo();
+    rack = saved;
+}
+
+/**
+ * Bound on the reply to a move, the window of the mover shifted by the points the move scored
+ * @param points
+ *          Points scored by the move
+ * @param bound
+ *          Alpha or beta of the mover
+ * @return Beta or alpha of the reply
+ */
+static int replyBound(int points, int bound) {
+    long long value = (long long) points - bound;
+    return (int) std::max<long long>(-INT_MAX, std::min<long long>(INT_MAX, value));
+}
+
+/**
+ * Negamax search of the side to move
+ * @param depth
+ *          Plies left before the line is cut off
+ * @param passed
+ *          Whether or not the opponent passed on the last turn
+ * @param line
+ *          Set to the best line from here
+ * @return Points the side to move ends up ahead from here on
+ */
+int EndgameSolver::search(int depth, int alpha, int beta, int side, bool passed, std::vector<Move>& line) {
+    line.clear();
+    if (++_nodes % ENDGAME_CHECK_NODES == 0 && _interruptible && outOfBudget()) _stopped = true;
+    if (_stopped) return 0;
+    if (depth == 0) { _horizon = true; return 0; }
+
+    // Without a table the entry is only written to and never read
+    std::uint64_t hash = key(side, passed);
+    Entry unused = Entry();
+    Entry& slot = _table.empty() ? unused : _table[hash & _table_mask];
+    bool known = !_table.empty() && slot.key == hash;
+    if (known && (slot.complete || slot.depth >= depth)) {
+        int value = slot.value;
+        if (slot.bound == EXACT || (slot.bound == LOWER && value >= beta) || (slot.bound == UPPER && value <= alpha)) {
+            if (!slot.complete) _horizon = true;
+            if (slot.bound == EXACT) followTable(slot.complete ? ENDGAME_MAX_DEPTH : depth, side, passed, line);
+            else line.push_back(slot.best);
+            return value;
+        }
+    }
+
+    std::string& rack = _racks[side];
+    const std::string& other = _racks[side ^ 1];
+
+    // Every move with the tiles it takes, and a pass at the end
+    std::vector<Move> moves;
+    _generator.generate(*_board, rack, [&moves](const Move& m) { moves.push_back(m); });
+    std::vector<std::pair<std::string, std::size_t> > order(moves.size());
+    for (std::size_t idx = 0; idx < moves.size(); ++idx) order[idx] = std::make_pair(tilesPlaced(*_board, moves[idx]), idx);
+    std::stable_sort(order.begin(), order.end(), [&](const std::pair<std::string, std::size_t>& a,
+                                                     const std::pair<std::string, std::size_t>& b) {
+        bool a_out = a.first.size() == rack.size(), b_out = b.first.size() == rack.size();
+        if (a_out != b_out) return a_out;
+        return moves[a.second].points > moves[b.second].points;
+    });
+    order.push_back(std::make_pair(std::string(), moves.size()));
+    moves.push_back(Move());
+
+    // The best move of an earlier search goes first
+    if (known) {
+        for (std::size_t idx = 0; idx < order.size(); ++idx) {
+            const Move& m = moves[order[idx].second];
+            if (m.word == slot.best.word && m.anchorX == slot.best.anchorX && m.anchorY == slot.best.anchorY &&
+                m.direction == slot.best.direction) {
+                std::rotate(order.begin(), order.begin() + idx, order.begin() + idx + 1);
+                break;
+            }
+        }
+    }
+
+    bool outer_horizon = _horizon;
+    _horizon = false;
+    int alpha_start = alpha, best = -INT_MAX;
+    Move best_move;
+    std::vector<Move> child;
+
+    for (std::size_t idx = 0; idx < order.size(); ++idx) {
+        const Move& m = moves[order[idx].second];
+        const std::string& placed = order[idx].first;
+        int value;
+
+        if (m.word.empty()) {
+            // Two passes in a row end the game
+            if (passed) { value = rackPoints(other) - rackPoints(rack); child.clear(); }
+            else value = -search(depth - 1, -beta, -alpha, side ^ 1, true, child);
+        }
+        else {
+            std::string saved = rack;
+            for (char tile : placed) rack.erase(rack.find(tile), 1);
+            _board->apply(m);
+            if (rack.empty()) { value = (int) m.points + 2 * rackPoints(other); child.clear(); }
+            else value = (int) m.points - search(depth - 1, replyBound(m.points, beta), replyBound(m.points, alpha),
+                                                 side ^ 1, false, child);
+            _board->undo();
+            rack = saved;
+        }
+        if (_stopped) return 0;
+
+        if (value > best) {
+            best = value;
+            best_move = m;
+            line.assign(1, m);
+            line.insert(line.end(), child.begin(), child.end());
+        }
+        alpha = std::max(alpha, value);
+        if (alpha >= beta) break;
+    }
+
+    slot.key = hash;
+    slot.best = best_move;
+    slot.value = (std::int16_t) best;
+    slot.depth = (std::int8_t) depth;
+    slot.bound = (best <= alpha_start) ? UPPER : (best >= beta) ? LOWER : EXACT;
+    slot.complete = !_horizon;
+
+    _horizon = outer_horizon || _horizon;
+    return best;
+}
@@ -0,0 +1,118 @@
+#ifndef ENDGAME_H
+#define ENDGAME_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "movegen.h"
+#include "solver.h"
+
+// Time an endgame is searched for unless told otherwise
+#define ENDGAME_MILLISECONDS 5000
+
+// Deepest search, in plies (a full rack each and a pass between every move)
+#define ENDGAME_MAX_DEPTH 30
+
+// The transposition table has 2^ENDGAME_TABLE_BITS entries unless told otherwise
+#define ENDGAME_TABLE_BITS 18
+
+// Nodes searched between checks of the time and node budgets
+#define ENDGAME_CHECK_NODES 1024
+
+/**
+ * Best line found for an endgame
+ */
+typedef struct EndgameResult {
+    int spread;                 // Points the side to move ends up ahead of the opponent from here on
+    std::vector<Move> line;     // Principal variation, a move without a word is a pass
+    int depth;                  // Deepest search that was completed, in plies
+    bool solved;                // Whether or not every line was searched to the end of the game
+    std::uint64_t nodes;        // Positions searched
+    double seconds;             // Time spent searching
+
+    EndgameResult() : spread(0), depth(0), solved(false), nodes(0), seconds(0) {};
+} endgame_result;
+
+/**
+ * Searches an endgame, when the bag is empty and both racks are known,
+ * for the line that leaves the side to move furthest ahead.
+ *
+ * The search is negamax with alpha-beta pruning, deepened one ply at a
+ * time until every line reaches the end of the game or the budget runs
+ * out. Moves that use the whole rack are tried first, then the others
+ * by points, with the best move from the transposition table before
+ * all of them. The table is keyed by the Zobrist hash of the board, the
+ * tiles on both racks and whether the last turn was a pass.
+ *
+ * The game ends when a player uses all their tiles (they gain twice the
+ * points left on the other rack in spread) or when both players pass in
+ * a row (each loses the points left on their own rack). A line that is
+ * cut off by the depth counts no further points.
+ */
+class EndgameSolver {
+public:
+    /**
+     * @param solver
+     *          Solver whose dictionary the moves come from
+     * @param table_bits
+     *          The transposition table has 2^table_bits entries, 0 for no table
+     */
+    explicit EndgameSolver(const Solver& solver, std::size_t table_bits = ENDGAME_TABLE_BITS);
+
+    EndgameSolver(const EndgameSolver&) = delete;
+    EndgameSolver& operator=(const EndgameSolver&) = delete;
+
+    /**
+     * Finds the best line of an endgame
+     * @param board
+     *          State of the Scrabble board, back to it when the search ends
+     * @param rack
+     *          Letters of the side to move
+     * @param opponent
+     *          Letters of the opponent
+     * @param milliseconds
+     *          Time budget, 0 for none
+     * @param max_nodes
+     *          Node budget, 0 for none
+     * @return Best line of the deepest search that was completed
+     */
+    EndgameResult solve(Board& board, const std::string& rack, const std::string& opponent,
+                        std::size_t milliseconds = ENDGAME_MILLISECONDS, std::uint64_t max_nodes = 0);
+
+private:
+    typedef struct Entry {
+        std::uint64_t key;
+        Move best;
+        std::int16_t value;
+        std::int8_t depth;
+        std::int8_t bound;      // EXACT, LOWER or UPPER
+        bool complete;          // Every line below reached the end of the game, so any depth can use it
+    } entry;
+
+    enum { EXACT, LOWER, UPPER };
+
+    int search(int depth, int alpha, int beta, int side, bool passed, std::vector<Move>& line);
+    void followTable(int depth, int side, bool passed, std::vector<Move>& line);
+    std::uint64_t key(int side, bool passed) const;
+    bool outOfBudget();
+
+    const Solver& _solver;
+    MoveGenerator _generator;
+    std::vector<Entry> _table;
+    std::uint64_t _table_mask;
+
+    Board* _board;
+    std::string _racks[2];
+
+    std::uint64_t _nodes, _max_nodes;
+    std::chrono::steady_clock::time_point _deadline;
+    bool _timed;
+    bool _interruptible;    // A search was completed, so the budget may stop the next one
+    bool _stopped;
+    bool _horizon;          // A line was cut off by the depth
+};
+
+#endif /* ENDGAME_H */
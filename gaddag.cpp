@@ -0,0 +1,463 @@
+#include "gaddag.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+    // Longest word that fits in a 16 byte key (word + separator)
+    const std::size_t MAX_KEY_LENGTH = 16;
+
+    /**
+     * A single GADDAG path packed into 16 bytes, one letter code per byte.
+     * Codes are 1-27 (letter index + 1) and unused bytes are 0, so comparing
+     * the two big-endian halves sorts keys lexicographically.
+     */
+    typedef struct Key {
+        std::uint64_t hi, lo;
+
+        bool operator<(const Key& other) const {
+            return hi < other.hi || (hi == other.hi && lo < other.lo);
+        }
+        bool operator==(const Key& other) const {
+            return hi == other.hi && lo == other.lo;
+        }
+
+        /**
+         * Letter index (0-26) at the given position of the key
+         */
+        int at(std::size_t i) const {
+            std::uint64_t half = (i < 8) ? hi : lo;
+            return (int) ((half >> ((7 - (i & 7)) << 3)) & 0xFF) - 1;
+        }
+
+        void set(std::size_t i, int letter) {
+            std::uint64_t code = (std::uint64_t) (letter + 1) << ((7 - (i & 7)) << 3);
+            if (i < 8) hi |= code;
+            else lo |= code;
+        }
+    } key;
+
+    /**
+     * Node on the current path of the incremental construction.
+     * The child of the most recently added letter is still being built
+     * and is only known once the next deeper node has been frozen.
+     */
+    typedef struct PendingNode {
+        std::uint32_t mask;
+        Gaddag::node_t children[GADDAG_ALPHABET];
+        int count;
+
+        PendingNode() : mask(0), count(0) {};
+    } pending_node;
+
+    /**
+     * Hashes a frozen node by its mask and children
+     */
+    struct NodeHash {
+        const std::vector<Gaddag::Node>* nodes;
+        const std::vector<Gaddag::node_t>* edges;
+
+        std::size_t operator()(Gaddag::node_t n) const {
+            const Gaddag::Node& nd = (*nodes)[n];
+            std::size_t h = nd.mask * 0x9E3779B97F4A7C15ull;
+            int count = popcount32(nd.mask & ~GADDAG_TERMINAL);
+            for (int i = 0; i < count; ++i)
+                h = (h ^ (*edges)[nd.edges + i]) * 0x100000001B3ull;
+            return h;
+        }
+    };
+
+    /**
+     * Two frozen nodes are equal if they have the same mask and children
+     */
+    struct NodeEqual {
+        const std::vector<Gaddag::Node>* nodes;
+        const std::vector<Gaddag::node_t>* edges;
+
+        bool operator()(Gaddag::node_t a, Gaddag::node_t b) const {
+            const Gaddag::Node& na = (*nodes)[a];
+            const Gaddag::Node& nb = (*nodes)[b];
+            if (na.mask != nb.mask) return false;
+            int count = popcount32(na.mask & ~GADDAG_TERMINAL);
+            return std::equal(edges->begin() + na.edges, edges->begin() + na.edges + count,
+                              edges->begin() + nb.edges);
+        }
+    };
+
+    /**
+     * Checks a compiled image before any of it is used. The header has to
+     * match the size of the file, and every node has to keep its edges
+     * inside the edge array and its children inside the node array, so a
+     * damaged image is turned down instead of walked out of bounds.
+     */
+    bool validImage(const char* base, std::size_t size) {
+        if (size < sizeof(Gaddag::ImageHeader)) return false;
+        const Gaddag::ImageHeader* header = reinterpret_cast<const Gaddag::ImageHeader*>(base);
+        if (std::memcmp(header->magic, GADDAG_MAGIC, sizeof(header->magic)) != 0 || header->version != GADDAG_VERSION)
+            return false;
+        if (header->node_count == 0 || header->root >= header->node_count) return false;
+
+        // Sizes are checked by dividing what is left so the products cannot overflow
+        std::size_t left = size - sizeof(Gaddag::ImageHeader);
+        if (header->node_count > left / sizeof(Gaddag::Node)) return false;
+        left -= header->node_count * sizeof(Gaddag::Node);
+        if (header->edge_count > left / sizeof(Gaddag::node_t) || left != header->edge_count * sizeof(Gaddag::node_t))
+            return false;
+
+        const Gaddag::Node* nodes = reinterpret_cast<const Gaddag::Node*>(base + sizeof(Gaddag::ImageHeader));
+        const Gaddag::node_t* edges = reinterpret_cast<const Gaddag::node_t*>(nodes + header->node_count);
+
+        // Node 0 stands for a missing edge and must not lead anywhere
+        if (nodes[Gaddag::NO_NODE].mask & ~GADDAG_TERMINAL) return false;
+        for (std::uint32_t n = 0; n < header->node_count; ++n) {
+            std::uint32_t mask = nodes[n].mask & ~GADDAG_TERMINAL;
+            if (mask >> GADDAG_ALPHABET) return false;
+            std::uint64_t end = (std::uint64_t) nodes[n].edges + popcount32(mask);
+            if (end > header->edge_count) return false;
+            for (std::uint64_t e = nodes[n].edges; e < end; ++e) {
+                if (edges[e] >= header->node_count) return false;
+            }
+        }
+        return true;
+    }
+}
+
+Gaddag::Gaddag() : _root(NO_NODE), _word_count(0), _mapping(nullptr), _mapping_size(0) {
+    // Node 0 has no edges so following an edge from a missing node stays missing
+    Node null_node = {0, 0};
+    _node_storage.push_back(null_node);
+    useStorage();
+}
+
+Gaddag::~Gaddag() {
+    unmap();
+}
+
+/**
+ * Points the arrays at the nodes and edges owned by this object
+ */
+void Gaddag::useStorage() {
+    _nodes = _node_storage.data();
+    _edges = _edge_storage.data();
+    _node_count = _node_storage.size();
+    _edge_count = _edge_storage.size();
+}
+
+/**
+ * Releases the mapped image, if there is one
+ */
+void Gaddag::unmap() {
+    if (!_mapping) return;
+    #if defined(_WIN32)
+        delete[] static_cast<char*>(_mapping);
+    #else
+        munmap(_mapping, _mapping_size);
+    #endif
+    _mapping = nullptr;
+    _mapping_size = 0;
+}
+
+/**
+ * Reads the dictionary one word per line and builds the GADDAG
+ */
+bool Gaddag::load(const std::string& filename) {
+    std::ifstream _file(filename);
+    if (!_file.is_open()) {
+        std::cout << "Dictionary file location is wrong\n";
+        return false;
+    }
+
+    std::vector<std::string> words;
+    std::string _word;
+    while (std::getline(_file, _word)) {
+        std::string upper;
+        for (char c : _word) {
+            if (c == '\r') continue;
+            upper += (char) std::toupper(c);
+        }
+        words.push_back(upper);
+    }
+    build(words);
+    return true;
+}
+
+/**
+ * Builds a minimal GADDAG using incremental construction over sorted paths.
+ * Every path is generated, sorted, and then added one at a time. Nodes
+ * that can no longer change are frozen into the flat arrays and merged
+ * with any identical node that already exists.
+ */
+void Gaddag::build(const std::vector<std::string>& words) {
+    unmap();
+    _node_storage.resize(1);
+    _edge_storage.clear();
+    _word_count = 0;
+
+    // Generate every REV(prefix) + SEPARATOR + suffix path
+    std::vector<Key> keys;
+    for (const std::string& word : words) {
+        std::size_t n = word.length();
+        if (n == 0 || n + 1 > MAX_KEY_LENGTH) continue;
+        bool valid = true;
+        for (char c : word) if (c < 'A' || c > 'Z') { valid = false; break; }
+        if (!valid) continue;
+        ++_word_count;
+
+        for (std::size_t split = 1; split <= n; ++split) {
+            Key k = {0, 0};
+            std::size_t pos = 0;
+            for (std::size_t i = split; i > 0; --i) k.set(pos++, word[i - 1] - 'A');
+            k.set(pos++, GADDAG_SEPARATOR);
+            for (std::size_t i = split; i < n; ++i) k.set(pos++, word[i] - 'A');
+            keys.push_back(k);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    NodeHash hasher = {&_node_storage, &_edge_storage};
+    NodeEqual equal = {&_node_storage, &_edge_storage};
+    std::unordered_set<node_t, NodeHash, NodeEqual> registry(keys.size() >> 2, hasher, equal);
+
+    // Freezes a pending node, reusing an identical node if one exists
+    auto freeze = [&](const PendingNode& pending) -> node_t {
+        Node frozen = {(std::uint32_t) _edge_storage.size(), pending.mask};
+        _edge_storage.insert(_edge_storage.end(), pending.children, pending.children + pending.count);
+        _node_storage.push_back(frozen);
+        node_t id = (node_t) (_node_storage.size() - 1);
+
+        auto found = registry.find(id);
+        if (found != registry.end()) {
+            _node_storage.pop_back();
+            _edge_storage.resize(frozen.edges);
+            return *found;
+        }
+        registry.insert(id);
+        return id;
+    };
+
+    PendingNode path[MAX_KEY_LENGTH + 1];
+    std::size_t prev_length = 0;
+    Key prev = {0, 0};
+
+    for (const Key& k : keys) {
+        std::size_t length = 0;
+        while (length < MAX_KEY_LENGTH && k.at(length) >= 0) ++length;
+
+        // Length of the prefix shared with the previous path
+        std::size_t common = 0;
+        while (common < length && common < prev_length && k.at(common) == prev.at(common)) ++common;
+
+        // Nodes deeper than the shared prefix will never change again
+        for (std::size_t d = prev_length; d > common; --d) {
+            node_t id = freeze(path[d]);
+            path[d - 1].children[path[d - 1].count - 1] = id;
+        }
+
+        // Add the rest of the path as new pending nodes
+        for (std::size_t d = common; d < length; ++d) {
+            int letter = k.at(d);
+            path[d].mask |= 1u << letter;
+            path[d].children[path[d].count++] = NO_NODE;
+            path[d + 1] = PendingNode();
+        }
+        path[length].mask |= GADDAG_TERMINAL;
+
+        prev = k;
+        prev_length = length;
+    }
+
+    for (std::size_t d = prev_length; d > 0; --d) {
+        node_t id = freeze(path[d]);
+        path[d - 1].children[path[d - 1].count - 1] = id;
+    }
+    _root = freeze(path[0]);
+    useStorage();
+}
+
+/**
+ * The image is the header followed by the raw node and edge arrays
+ */
+bool Gaddag::save(const std::string& filename) const {
+    std::ofstream _file(filename, std::ios::binary | std::ios::trunc);
+    if (!_file.is_open()) {
+        std::cout << "Unable to write dictionary image\n";
+        return false;
+    }
+
+    ImageHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, GADDAG_MAGIC, sizeof(header.magic));
+    header.version = GADDAG_VERSION;
+    header.root = _root;
+    header.node_count = (std::uint32_t) _node_count;
+    header.edge_count = (std::uint32_t) _edge_count;
+    header.word_count = (std::uint32_t) _word_count;
+
+    _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    _file.write(reinterpret_cast<const char*>(_nodes), _node_count * sizeof(Node));
+    _file.write(reinterpret_cast<const char*>(_edges), _edge_count * sizeof(node_t));
+    return _file.good();
+}
+
+/**
+ * Maps the image read-only so every process using the same image
+ * shares the same physical pages. The header and the nodes are
+ * checked against the size of the file before the arrays are used.
+ */
+bool Gaddag::map(const std::string& filename) {
+    void* mapping = nullptr;
+    std::size_t size = 0;
+
+    #if defined(_WIN32)
+        // Without mmap the image is read into memory in one piece
+        std::ifstream _file(filename, std::ios::binary | std::ios::ate);
+        if (!_file.is_open()) return false;
+        size = (std::size_t) _file.tellg();
+        char* buffer = new char[size];
+        _file.seekg(0);
+        _file.read(buffer, size);
+        mapping = buffer;
+    #else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            size = (std::size_t) info.st_size;
+            mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (mapping == MAP_FAILED) mapping = nullptr;
+        }
+        close(fd);
+        if (!mapping) return false;
+    #endif
+
+    // A bad image is released before it replaces the arrays in use
+    if (!validImage(static_cast<const char*>(mapping), size)) {
+        std::cout << "Dictionary image is invalid\n";
+        #if defined(_WIN32)
+            delete[] static_cast<char*>(mapping);
+        #else
+            munmap(mapping, size);
+        #endif
+        return false;
+    }
+
+    unmap();
+    _mapping = mapping;
+    _mapping_size = size;
+
+    // The arrays are used in place, nothing owned is kept around
+    std::vector<Node>().swap(_node_storage);
+    std::vector<node_t>().swap(_edge_storage);
+
+    const ImageHeader* header = static_cast<const ImageHeader*>(mapping);
+    const char* base = static_cast<const char*>(mapping);
+    _nodes = reinterpret_cast<const Node*>(base + sizeof(ImageHeader));
+    _edges = reinterpret_cast<const node_t*>(base + sizeof(ImageHeader) + header->node_count * sizeof(Node));
+    _node_count = header->node_count;
+    _edge_count = header->edge_count;
+    _root = header->root;
+    _word_count = header->word_count;
+    return true;
+}
+
+/**
+ * A word c1..cn is in the GADDAG as c1 + SEPARATOR + c2..cn
+ */
+bool Gaddag::contains(const std::string& word) const {
+    if (word.empty()) return false;
+    node_t n = next(_root, word[0] - 'A');
+    n = next(n, GADDAG_SEPARATOR);
+    for (std::size_t i = 1; i < word.length() && n != NO_NODE; ++i)
+        n = next(n, word[i] - 'A');
+    return n != NO_NODE && isTerminal(n);
+}
+
+/**
+ * Every word c1..cn is read back from the path c1 + SEPARATOR + c2..cn
+ */
+std::vector<std::string> Gaddag::words() const {
+    std::vector<std::string> result;
+    result.reserve(_word_count);
+
+    // Depth-first walk of the suffixes after the separator
+    std::vector<std::pair<node_t, std::uint32_t> > stack;
+    std::string word;
+    std::uint32_t first_letters = letters(_root);
+    while (first_letters) {
+        int first = lowestBit32(first_letters);
+        first_letters &= first_letters - 1;
+
+        node_t start = next(next(_root, first), GADDAG_SEPARATOR);
+        if (start == NO_NODE) continue;
+        word.assign(1, (char) ('A' + first));
+        if (isTerminal(start)) result.push_back(word);
+        stack.push_back(std::make_pair(start, letters(start)));
+
+        while (!stack.empty()) {
+            std::uint32_t& remaining = stack.back().second;
+            if (!remaining) {
+                stack.pop_back();
+                word.erase(word.length() - 1);
+                continue;
+            }
+            int letter = lowestBit32(remaining);
+            remaining &= remaining - 1;
+
+            node_t child = next(stack.back().first, letter);
+            word += (char) ('A' + letter);
+            if (isTerminal(child)) result.push_back(word);
+            stack.push_back(std::make_pair(child, letters(child)));
+        }
+    }
+    return result;
+}
+
+/**
+ * If there is a prefix, the shared part REV(prefix) + SEPARATOR is walked
+ * once and every letter leaving it is tried against the suffix.
+ * Without a prefix, each letter is tried as the first letter of the word.
+ */
+std::uint32_t Gaddag::crossCheck(const std::string& prefix, const std::string& suffix) const {
+    std::uint32_t result = 0;
+
+    if (!prefix.empty()) {
+        node_t n = _root;
+        for (std::size_t i = prefix.length(); i > 0 && n != NO_NODE; --i)
+            n = next(n, prefix[i - 1] - 'A');
+        n = next(n, GADDAG_SEPARATOR);
+
+        std::uint32_t candidates = letters(n);
+        while (candidates) {
+            int letter = lowestBit32(candidates);
+            candidates &= candidates - 1;
+            node_t m = next(n, letter);
+            for (std::size_t i = 0; i < suffix.length() && m != NO_NODE; ++i)
+                m = next(m, suffix[i] - 'A');
+            if (m != NO_NODE && isTerminal(m)) result |= 1u << letter;
+        }
+        return result;
+    }
+
+    std::uint32_t candidates = letters(_root);
+    while (candidates) {
+        int letter = lowestBit32(candidates);
+        candidates &= candidates - 1;
+        node_t m = next(next(_root, letter), GADDAG_SEPARATOR);
+        for (std::size_t i = 0; i < suffix.length() && m != NO_NODE; ++i)
+            m = next(m, suffix[i] - 'A');
+        if (m != NO_NODE && isTerminal(m)) result |= 1u << letter;
+    }
+    return result;
+}
@@ -0,0 +1,219 @@
+#ifndef GADDAG_H
+#define GADDAG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Letters are stored as indices 0-25 (A-Z) inside the GADDAG.
+ * The separator marks the point where a path stops reading the
+ * reversed prefix of a word and starts reading the suffix.
+ */
+#define GADDAG_SEPARATOR 26
+#define GADDAG_ALPHABET 27
+
+// Bit in a node's mask that marks the end of a complete path
+#define GADDAG_TERMINAL 0x80000000u
+
+// Mask covering the 26 letters of the alphabet (no separator)
+#define GADDAG_LETTERS 0x03FFFFFFu
+
+// Identifies a compiled GADDAG image and the version of its layout
+#define GADDAG_MAGIC "SCRBGDAG"
+#define GADDAG_VERSION 1
+
+/**
+ * Counts the number of set bits in a 32-bit mask
+ */
+inline int popcount32(std::uint32_t mask) {
+#if defined(__GNUC__)
+    return __builtin_popcount(mask);
+#else
+    mask = mask - ((mask >> 1) & 0x55555555u);
+    mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+    return (int) ((((mask + (mask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+#endif
+}
+
+/**
+ * Index of the lowest set bit in a non-zero 32-bit mask
+ */
+inline int lowestBit32(std::uint32_t mask) {
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    int idx = 0;
+    while (!(mask & 1u)) { mask >>= 1; ++idx; }
+    return idx;
+#endif
+}
+
+/**
+ * A GADDAG is a minimized automaton that contains, for every word
+ * c1..cn in the dictionary and every split point i, the path
+ * REV(c1..ci) + SEPARATOR + c(i+1)..cn.
+ * Starting at any letter of a word, the word can be read by first
+ * walking left (reversed) and then switching to the right with the
+ * separator, which is exactly what is needed to build words outwards
+ * from an anchor square on the board.
+ *
+ * Nodes are stored as a 26-bit letter mask plus the index of their
+ * first child in a flat edge array, so following an edge is a bit test
+ * and a popcount with no searching.
+ *
+ * The arrays can be built from the text dictionary, or saved once to a
+ * binary image and then memory-mapped, in which case they are used in
+ * place straight from the page cache and shared between processes.
+ */
+class Gaddag {
+public:
+    typedef std::uint32_t node_t;
+
+    // Node index that represents a missing edge
+    static const node_t NO_NODE = 0;
+
+    /**
+     * A node of the automaton.
+     * mask:  bits 0-26 are the outgoing letters, bit 31 is set if the
+     *        path leading to the node is complete
+     * edges: index of the first child inside the edge array
+     */
+    typedef struct Node {
+        std::uint32_t edges;
+        std::uint32_t mask;
+    } node;
+
+    /**
+     * Layout of the start of a compiled image. The node array follows
+     * the header and the edge array follows the nodes, all stored in the
+     * byte order of the machine that compiled the image.
+     */
+    typedef struct ImageHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t root;
+        std::uint32_t node_count;
+        std::uint32_t edge_count;
+        std::uint32_t word_count;
+        std::uint32_t reserved;
+    } image_header;
+
+    Gaddag();
+    ~Gaddag();
+
+    // The arrays may point into a mapping owned by this object
+    Gaddag(const Gaddag&) = delete;
+    Gaddag& operator=(const Gaddag&) = delete;
+
+    /**
+     * Builds the GADDAG from a dictionary file with one word per line
+     * @param filename
+     *          Location of the dictionary file
+     * @return True if the dictionary was read and the GADDAG built
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * Builds the GADDAG from a list of uppercase words
+     */
+    void build(const std::vector<std::string>& words);
+
+    /**
+     * Writes the GADDAG to a binary image that can be mapped with "map"
+     * @param filename
+     *          Location of the image to write
+     * @return True if the whole image was written
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * Memory-maps a binary image written by "save".
+     * Nothing is parsed or copied, the image is used in place.
+     * @param filename
+     *          Location of the compiled image
+     * @return True if the image exists and is valid
+     */
+    bool map(const std::string& filename);
+
+    /**
+     * Root of the automaton
+     */
+    node_t root() const { return _root; }
+
+    /**
+     * Follows the edge with the given letter index
+     * @return The child node, NO_NODE if the edge does not exist
+     */
+    node_t next(node_t n, int letter) const {
+        std::uint32_t mask = _nodes[n].mask;
+        if (!((mask >> letter) & 1u)) return NO_NODE;
+        return _edges[_nodes[n].edges + popcount32(mask & ((1u << letter) - 1u))];
+    }
+
+    /**
+     * Mask of letters (A-Z, not the separator) leaving the given node
+     */
+    std::uint32_t letters(node_t n) const { return _nodes[n].mask & GADDAG_LETTERS; }
+
+    /**
+     * Whether or not the path leading to the node is a complete entry
+     */
+    bool isTerminal(node_t n) const { return (_nodes[n].mask & GADDAG_TERMINAL) != 0; }
+
+    /**
+     * Checks whether the given uppercase word is in the dictionary
+     */
+    bool contains(const std::string& word) const;
+
+    /**
+     * Lists every word in the dictionary in alphabetical order
+     */
+    std::vector<std::string> words() const;
+
+    /**
+     * Letters that can be placed between a prefix and a suffix to form a word
+     * @param prefix
+     *          Letters that come before the square (may be empty)
+     * @param suffix
+     *          Letters that come after the square (may be empty)
+     * @return Mask of letter indices that complete a dictionary word
+     */
+    std::uint32_t crossCheck(const std::string& prefix, const std::string& suffix) const;
+
+    /**
+     * Number of nodes and edges in the automaton
+     */
+    std::size_t nodeCount() const { return _node_count; }
+    std::size_t edgeCount() const { return _edge_count; }
+
+    /**
+     * Number of words stored in the automaton
+     */
+    std::size_t wordCount() const { return _word_count; }
+
+    /**
+     * Whether or not the arrays come from a memory-mapped image
+     */
+    bool isMapped() const { return _mapping != nullptr; }
+
+private:
+    void unmap();
+    void useStorage();
+
+    const Node* _nodes;
+    const node_t* _edges;
+    std::size_t _node_count, _edge_count;
+    node_t _root;
+    std::size_t _word_count;
+
+    // Arrays owned by a GADDAG that was built from a word list
+    std::vector<Node> _node_storage;
+    std::vector<node_t> _edge_storage;
+
+    // Image mapped into memory by "map"
+    void* _mapping;
+    std::size_t _mapping_size;
+};
+
+#endif /* GADDAG_H */
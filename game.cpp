@@ -0,0 +1,55 @@
+#include "game.h"
+
+#include "bag.h"
+#include "simulate.h"
+
+int rackPoints(const std::string& rack) {
+    int points = 0;
+    for (char c : rack) points += letterValue(c);
+    return points;
+}
+
+GameResult playGame(const Solver& solver, std::uint64_t seed, std::ostream* positions) {
+    GameResult result;
+    Board board;
+    computeCrossChecks(board, solver.gaddag());
+
+    TileBag bag(fullBag(), seed);
+    std::string racks[2];
+    bag.draw(racks[0]);
+    bag.draw(racks[1]);
+
+    int scoreless = 0;
+    for (int player = 0; ; player ^= 1) {
+        std::string& rack = racks[player];
+        if (positions) writePosition(*positions, board, rack);
+
+        Move move = solver.findBestWord(board, rack);
+        ++result.turns;
+
+        // A move worth nothing is still played, only a rack without a legal move passes
+        if (move.word.empty()) {
+            if (++scoreless < GAME_SCORELESS_TURNS) continue;
+            result.scores[0] -= rackPoints(racks[0]);
+            result.scores[1] -= rackPoints(racks[1]);
+            break;
+        }
+        scoreless = 0;
+
+        std::string placed = tilesPlaced(board, move);
+        for (char tile : placed) rack.erase(rack.find(tile), 1);
+        board.apply(move);
+        result.scores[player] += (int) move.points;
+        if (placed.size() == RACK_SIZE) ++result.bingos;
+
+        bag.draw(rack);
+        if (rack.empty()) {
+            int left = rackPoints(racks[player ^ 1]);
+            result.scores[player] += left;
+            result.scores[player ^ 1] -= left;
+            result.went_out = true;
+            break;
+        }
+    }
+    return result;
+}
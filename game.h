@@ -0,0 +1,51 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "board.h"
+#include "solver.h"
+
+// Passes in a row that end the game
+#define GAME_SCORELESS_TURNS 6
+
+/**
+ * Outcome of a self-play game
+ */
+typedef struct GameResult {
+    int scores[2];      // Final scores, after the tiles left on the racks are counted
+    int turns;          // Turns played, passes included
+    int bingos;         // Moves that used all seven tiles
+    bool went_out;      // Whether or not a player used their last tile with the bag empty
+
+    GameResult() : turns(0), bingos(0), went_out(false) { scores[0] = scores[1] = 0; };
+} game_result;
+
+/**
+ * Point value of the tiles on a rack, 0 for a blank
+ */
+int rackPoints(const std::string& rack);
+
+/**
+ * Plays a whole game between two players who both play the solver's move.
+ *
+ * The racks are drawn from a full bag of 100 tiles and refilled after
+ * every move. A player with no move passes. The game ends when a player
+ * uses their last tile with the bag empty, and gains the points of the
+ * opponent's tiles while the opponent loses them, or after
+ * GAME_SCORELESS_TURNS passes in a row, and then each
+ * player loses the points of their own tiles.
+ * @param solver
+ *          Solver that picks every move
+ * @param seed
+ *          Seed of the tile draws, the same seed plays the same game
+ * @param positions
+ *          If not null, the position before every turn is written to it
+ *          in the format read by readPosition
+ * @return Scores and turns of the game
+ */
+GameResult playGame(const Solver& solver, std::uint64_t seed, std::ostream* positions = nullptr);
+
+#endif /* GAME_H */
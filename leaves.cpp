@@ -0,0 +1,266 @@
+#include "leaves.h"
+#include "gaddag.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+    // Largest spread out tile of a leave is 26 + LEAVE_MAX_TILES - 1
+    const int BINOMIAL_ROWS = LEAVE_ALPHABET + LEAVE_MAX_TILES;
+
+    /**
+     * Binomial coefficients C(n, k) for every n and k a leave needs, and the
+     * index of the first leave of each size
+     */
+    typedef struct Ranks {
+        std::uint32_t binomial[BINOMIAL_ROWS][LEAVE_MAX_TILES + 2];
+        std::uint32_t first[LEAVE_MAX_TILES + 2];
+
+        Ranks() {
+            std::memset(binomial, 0, sizeof(binomial));
+            for (int n = 0; n < BINOMIAL_ROWS; ++n) {
+                binomial[n][0] = 1;
+                for (int k = 1; k <= LEAVE_MAX_TILES + 1 && k <= n; ++k)
+                    binomial[n][k] = binomial[n - 1][k - 1] + (k < n ? binomial[n - 1][k] : 0);
+            }
+            first[0] = 0;
+            for (int k = 0; k <= LEAVE_MAX_TILES; ++k)
+                first[k + 1] = first[k] + binomial[LEAVE_ALPHABET - 1 + k][k];
+        }
+    } ranks;
+
+    const Ranks RANKS;
+
+    /**
+     * Rough equity of each tile kept on its own, A-Z and then the blank
+     */
+    const double TILE_LEAVE[LEAVE_ALPHABET] = {
+        1.0, -2.0, 0.5, 0.5, 4.0, -2.0, -2.0, 1.0, -1.0, -1.5, -1.0, -0.5, 0.5, // A - M
+        0.5, -1.5, -0.5, -7.0, 1.5, 8.0, 0.0, -3.0, -5.5, -4.0, 3.5, -0.5, 5.0, // N - Z
+        25.0                                                                     // Blank
+    };
+
+    /**
+     * Rough equity of a leave, see LeaveTable::estimate
+     */
+    double estimateLeave(const int counts[LEAVE_ALPHABET]) {
+        double points = 0;
+        int vowels = 0, consonants = 0;
+        for (int tile = 0; tile < LEAVE_ALPHABET; ++tile) {
+            if (!counts[tile]) continue;
+            points += TILE_LEAVE[tile] * counts[tile];
+
+            // Every copy after the first is worth less and less
+            points -= 3.0 * (counts[tile] - 1) * counts[tile] / 2;
+
+            if (tile == LEAVE_ALPHABET - 1) continue;
+            if (std::strchr("AEIOU", 'A' + tile)) vowels += counts[tile];
+            else consonants += counts[tile];
+        }
+        if (counts['Q' - 'A'] && !counts['U' - 'A']) points -= 3.0;
+
+        // Two vowels to every three consonants draws best
+        int tiles = vowels + consonants;
+        points -= 1.5 * std::fabs(vowels - 0.4 * tiles);
+        return points;
+    }
+
+    /**
+     * Calls the function with the counts of every leave of up to LEAVE_MAX_TILES tiles
+     */
+    template <typename F>
+    void forEachLeave(int counts[LEAVE_ALPHABET], int tile, int tiles, F& fn) {
+        if (tile == LEAVE_ALPHABET) { fn(counts); return; }
+        for (int count = 0; tiles + count <= LEAVE_MAX_TILES; ++count) {
+            counts[tile] = count;
+            forEachLeave(counts, tile + 1, tiles + count, fn);
+        }
+        counts[tile] = 0;
+    }
+}
+
+LeaveTable::LeaveTable() : _values(nullptr), _mapping(nullptr), _mapping_size(0) {}
+
+LeaveTable::~LeaveTable() {
+    unmap();
+}
+
+std::uint32_t LeaveTable::size() {
+    return RANKS.first[LEAVE_MAX_TILES + 1];
+}
+
+/**
+ * Walks the tiles in sorted order, the i-th tile t adds C(t + i, i + 1)
+ */
+std::uint32_t LeaveTable::index(const int letters[26], int blanks) {
+    std::uint32_t rank = 0;
+    int tiles = 0;
+    for (int tile = 0; tile < LEAVE_ALPHABET; ++tile) {
+        int count = (tile < 26) ? letters[tile] : blanks;
+        if (tiles + count > LEAVE_MAX_TILES) return size();
+        for (int copy = 0; copy < count; ++copy, ++tiles)
+            rank += RANKS.binomial[tile + tiles][tiles + 1];
+    }
+    return RANKS.first[tiles] + rank;
+}
+
+std::uint32_t LeaveTable::index(const int letters[26], std::uint32_t mask, int blanks) {
+    std::uint32_t rank = 0;
+    int tiles = 0;
+    for (; mask; mask &= mask - 1) {
+        int tile = lowestBit32(mask);
+        if (tiles + letters[tile] > LEAVE_MAX_TILES) return size();
+        for (int copy = 0; copy < letters[tile]; ++copy, ++tiles)
+            rank += RANKS.binomial[tile + tiles][tiles + 1];
+    }
+    if (tiles + blanks > LEAVE_MAX_TILES) return size();
+    for (int copy = 0; copy < blanks; ++copy, ++tiles)
+        rank += RANKS.binomial[LEAVE_ALPHABET - 1 + tiles][tiles + 1];
+    return RANKS.first[tiles] + rank;
+}
+
+std::uint32_t LeaveTable::index(const std::string& leave) {
+    int letters[26] = {0}, blanks = 0;
+    for (char c : leave) {
+        if (c == ' ' || c == '?') ++blanks;
+        else if (std::toupper(c) >= 'A' && std::toupper(c) <= 'Z') ++letters[std::toupper(c) - 'A'];
+    }
+    return index(letters, blanks);
+}
+
+/**
+ * Stores the value of a leave in the owned values, rounded to the table's scale
+ */
+void LeaveTable::set(std::uint32_t idx, double points) {
+    double scaled = std::round(points * LEAVE_SCALE);
+    _storage[idx] = (value_t) std::max(-32768.0, std::min(32767.0, scaled));
+}
+
+void LeaveTable::estimate() {
+    unmap();
+    _storage.assign(size(), 0);
+    _values = _storage.data();
+
+    int counts[LEAVE_ALPHABET] = {0};
+    auto fill = [this](const int* leave) { set(index(leave, leave[26]), estimateLeave(leave)); };
+    forEachLeave(counts, 0, 0, fill);
+}
+
+bool LeaveTable::load(const std::string& filename) {
+    std::ifstream _file(filename);
+    if (!_file.is_open()) {
+        std::cout << "Leave file location is wrong\n";
+        return false;
+    }
+    if (_storage.empty()) _storage.assign(size(), 0);
+    unmap();
+    _values = _storage.data();
+
+    std::string _line;
+    while (std::getline(_file, _line)) {
+        std::istringstream fields(_line);
+        std::string leave;
+        double points;
+        if (!(fields >> leave >> points)) continue;
+        std::uint32_t idx = index(leave);
+        if (idx < size()) set(idx, points);
+    }
+    return true;
+}
+
+bool LeaveTable::save(const std::string& filename) const {
+    std::ofstream _file(filename, std::ios::binary | std::ios::trunc);
+    if (!_file.is_open() || !_values) {
+        std::cout << "Unable to write leave table\n";
+        return false;
+    }
+
+    ImageHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, LEAVE_MAGIC, sizeof(header.magic));
+    header.version = LEAVE_VERSION;
+    header.count = size();
+    header.scale = LEAVE_SCALE;
+
+    _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    _file.write(reinterpret_cast<const char*>(_values), size() * sizeof(value_t));
+    return _file.good();
+}
+
+/**
+ * Maps the image read-only, the same way as the dictionary image.
+ * The header is checked against the size of the file before the
+ * values are used.
+ */
+bool LeaveTable::map(const std::string& filename) {
+    void* mapping = nullptr;
+    std::size_t bytes = 0;
+
+    #if defined(_WIN32)
+        std::ifstream _file(filename, std::ios::binary | std::ios::ate);
+        if (!_file.is_open()) return false;
+        bytes = (std::size_t) _file.tellg();
+        char* buffer = new char[bytes];
+        _file.seekg(0);
+        _file.read(buffer, bytes);
+        mapping = buffer;
+    #else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            bytes = (std::size_t) info.st_size;
+            mapping = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+            if (mapping == MAP_FAILED) mapping = nullptr;
+        }
+        close(fd);
+        if (!mapping) return false;
+    #endif
+
+    const ImageHeader* header = static_cast<const ImageHeader*>(mapping);
+    bool valid = bytes >= sizeof(ImageHeader) &&
+                 std::memcmp(header->magic, LEAVE_MAGIC, sizeof(header->magic)) == 0 &&
+                 header->version == LEAVE_VERSION && header->count == size() &&
+                 header->scale == LEAVE_SCALE &&
+                 bytes == sizeof(ImageHeader) + header->count * sizeof(value_t);
+
+    unmap();
+    _mapping = mapping;
+    _mapping_size = bytes;
+    if (!valid) {
+        std::cout << "Leave table is invalid\n";
+        unmap();
+        return false;
+    }
+
+    std::vector<value_t>().swap(_storage);
+    _values = reinterpret_cast<const value_t*>(static_cast<const char*>(mapping) + sizeof(ImageHeader));
+    return true;
+}
+
+/**
+ * Releases the mapped image, if there is one
+ */
+void LeaveTable::unmap() {
+    if (!_mapping) return;
+    #if defined(_WIN32)
+        delete[] static_cast<char*>(_mapping);
+    #else
+        munmap(_mapping, _mapping_size);
+    #endif
+    _mapping = nullptr;
+    _mapping_size = 0;
+    _values = _storage.empty() ? nullptr : _storage.data();
+}
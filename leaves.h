@@ -0,0 +1,151 @@
+#ifndef LEAVES_H
+#define LEAVES_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Identifies a compiled leave table and the version of its layout
+#define LEAVE_MAGIC "SCRBLEAV"
+#define LEAVE_VERSION 1
+
+// Leave table compiled by the compile_leaves program, loaded by the solver if it exists
+#define LEAVES_IMAGE "scrabble_leaves.leave"
+
+// Most tiles in a leave (one less than a full rack)
+#define LEAVE_MAX_TILES 6
+
+// Kinds of tiles in a leave: A-Z and then the blank
+#define LEAVE_ALPHABET 27
+
+// Values are stored in hundredths of a point
+#define LEAVE_SCALE 100
+
+/**
+ * Equity of every leave (the tiles kept on the rack after a move) of up
+ * to LEAVE_MAX_TILES tiles, in points.
+ *
+ * A leave is a multiset of tiles, so it is ranked by its sorted tiles
+ * t1 <= t2 <= ... <= tk with the combinatorial number system: the tiles
+ * are spread out to ti + i, which makes them a strictly increasing
+ * combination, and every combination of k has its own rank below
+ * C(26 + k, k). Leaves of k tiles come after all the shorter ones, so
+ * every leave has its own index and the table has no holes: the value
+ * of a leave is one lookup at the index computed from its tile counts.
+ *
+ * The table is written once to a binary image and memory-mapped like
+ * the dictionary image.
+ */
+class LeaveTable {
+public:
+    typedef std::int16_t value_t;
+
+    /**
+     * Layout of the start of a compiled table, the values follow it
+     * in the byte order of the machine that compiled the table
+     */
+    typedef struct ImageHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t count;
+        std::uint32_t scale;
+        std::uint32_t reserved;
+    } image_header;
+
+    LeaveTable();
+    ~LeaveTable();
+
+    // The values may point into a mapping owned by this object
+    LeaveTable(const LeaveTable&) = delete;
+    LeaveTable& operator=(const LeaveTable&) = delete;
+
+    /**
+     * Number of leaves of up to LEAVE_MAX_TILES tiles
+     */
+    static std::uint32_t size();
+
+    /**
+     * Index of a leave given how many of each tile it has
+     * @param letters
+     *          Count of each letter A-Z
+     * @param blanks
+     *          Number of blanks
+     * @return Index of the leave, size() if it has too many tiles
+     */
+    static std::uint32_t index(const int letters[26], int blanks);
+
+    /**
+     * Index of a leave given its letter counts along with the mask of the
+     * letters it has (bit 0 = A), so only those letters are looked at
+     */
+    static std::uint32_t index(const int letters[26], std::uint32_t mask, int blanks);
+
+    /**
+     * Index of a leave written as letters, '?' or ' ' for a blank
+     */
+    static std::uint32_t index(const std::string& leave);
+
+    /**
+     * Fills the table with a rough estimate of every leave: the value of
+     * each tile on its own, less a penalty for duplicates, for too many
+     * vowels or consonants and for a Q without a U
+     */
+    void estimate();
+
+    /**
+     * Reads values from a text file with one leave and its value per
+     * line ("?ERS 34.5"). Leaves that aren't listed keep their value.
+     * @return True if the file was read
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * Writes the table to a binary image that can be mapped with "map"
+     * @return True if the whole image was written
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * Memory-maps a binary image written by "save"
+     * @return True if the image exists and is valid
+     */
+    bool map(const std::string& filename);
+
+    /**
+     * Whether or not the table has values
+     */
+    bool isLoaded() const { return _values != nullptr; }
+
+    /**
+     * Equity of a leave in points, 0 if it has too many tiles
+     */
+    float value(const int letters[26], int blanks) const {
+        std::uint32_t idx = index(letters, blanks);
+        return (idx < size()) ? _values[idx] * (1.0f / LEAVE_SCALE) : 0.0f;
+    }
+
+    float value(const int letters[26], std::uint32_t mask, int blanks) const {
+        std::uint32_t idx = index(letters, mask, blanks);
+        return (idx < size()) ? _values[idx] * (1.0f / LEAVE_SCALE) : 0.0f;
+    }
+
+    float value(const std::string& leave) const {
+        std::uint32_t idx = index(leave);
+        return (idx < size()) ? _values[idx] * (1.0f / LEAVE_SCALE) : 0.0f;
+    }
+
+private:
+    void unmap();
+    void set(std::uint32_t idx, double points);
+
+    const value_t* _values;
+
+    // Values owned by a table that was estimated or read from text
+    std::vector<value_t> _storage;
+
+    // Image mapped into memory by "map"
+    void* _mapping;
+    std::size_t _mapping_size;
+};
+
+#endif /* LEAVES_H */
@@ -0,0 +1,118 @@
+#include "lexicon.h"
+
+#include <algorithm>
+
+#include "board.h"
+#include "gaddag.h"
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+LetterCounts LetterCounts::of(const std::string& letters) {
+    LetterCounts result;
+    for (char c : letters) {
+        if (c == WILDCARD || c == WILDCARD_ALIAS) ++result.blanks;
+        if (c < 'A' || c > 'Z') continue;
+        ++result.counts[c - 'A'];
+        result.mask |= 1u << (c - 'A');
+    }
+    return result;
+}
+
+/**
+ * Compares all the counts at once: a byte is set in the comparison
+ * result only where this histogram needs more of a letter than the
+ * other one has. Counts never exceed 15, so a signed compare is safe.
+ */
+bool LetterCounts::fitsIn(const LetterCounts& other) const {
+    if (mask & ~other.mask) return false;
+
+    #if defined(__AVX2__)
+        __m256i mine = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts));
+        __m256i theirs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(other.counts));
+        return _mm256_movemask_epi8(_mm256_cmpgt_epi8(mine, theirs)) == 0;
+    #elif defined(__SSE2__)
+        __m128i low = _mm_cmpgt_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(counts)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(other.counts)));
+        __m128i high = _mm_cmpgt_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(counts + 16)),
+                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(other.counts + 16)));
+        return _mm_movemask_epi8(_mm_or_si128(low, high)) == 0;
+    #else
+        for (int i = 0; i < 26; ++i)
+            if (counts[i] > other.counts[i]) return false;
+        return true;
+    #endif
+}
+
+/**
+ * Subtracts all the counts at once with unsigned saturation, so only
+ * the letters this histogram needs more of are left, and adds them up
+ * with a sum of absolute differences against zero
+ */
+int LetterCounts::shortfall(const LetterCounts& other) const {
+    #if defined(__AVX2__)
+        __m256i excess = _mm256_subs_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts)),
+                                          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(other.counts)));
+        __m256i sums = _mm256_sad_epu8(excess, _mm256_setzero_si256());
+        return (int) (_mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1) +
+                      _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3));
+    #elif defined(__SSE2__)
+        __m128i low = _mm_subs_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(counts)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(other.counts)));
+        __m128i high = _mm_subs_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(counts + 16)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(other.counts + 16)));
+        __m128i sums = _mm_sad_epu8(_mm_add_epi8(low, high), _mm_setzero_si128());
+        return _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    #else
+        int total = 0;
+        for (int i = 0; i < 26; ++i)
+            if (counts[i] > other.counts[i]) total += counts[i] - other.counts[i];
+        return total;
+    #endif
+}
+
+void Lexicon::build(const std::vector<std::string>& words) {
+    _words.clear();
+    for (Bucket& b : _buckets) b = Bucket();
+
+    for (const std::string& word : words) {
+        if (word.empty() || word.length() > LEXICON_MAX_LENGTH) continue;
+        LetterCounts histogram = LetterCounts::of(word);
+        Bucket& b = _buckets[word.length()];
+        b.masks.push_back(histogram.mask);
+        b.counts.push_back(histogram);
+        b.words.push_back((std::uint32_t) _words.size());
+        _words.push_back(word);
+    }
+}
+
+/**
+ * Only the buckets for lengths that fit in the letters are scanned
+ */
+std::vector<std::string> Lexicon::wordsFrom(const std::string& letters, std::size_t min_length) const {
+    std::vector<std::string> result;
+    LetterCounts rack = LetterCounts::of(letters);
+    std::uint32_t missing = ~rack.mask;
+
+    std::size_t max_length = std::min<std::size_t>(letters.length(), LEXICON_MAX_LENGTH);
+    for (std::size_t length = std::max<std::size_t>(min_length, 1); length <= max_length; ++length) {
+        const Bucket& b = _buckets[length];
+        if (!rack.blanks) {
+            for (std::size_t idx = 0; idx < b.masks.size(); ++idx) {
+                if (b.masks[idx] & missing) continue;
+                if (b.counts[idx].fitsIn(rack)) result.push_back(_words[b.words[idx]]);
+            }
+            continue;
+        }
+
+        // Every blank covers one letter the rack is short of
+        for (std::size_t idx = 0; idx < b.masks.size(); ++idx) {
+            if (popcount32(b.masks[idx] & missing) > rack.blanks) continue;
+            if (b.counts[idx].shortfall(rack) <= rack.blanks) result.push_back(_words[b.words[idx]]);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,93 @@
+#ifndef LEXICON_H
+#define LEXICON_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Longest word the lexicon keeps (a word has to fit on the board)
+#define LEXICON_MAX_LENGTH 15
+
+/**
+ * Letter histogram of a word or a rack.
+ * The mask has bit i set if letter i (A = 0) appears at least once,
+ * and counts[i] is the number of times letter i appears. The counts
+ * are padded to 32 bytes so they can be compared in one or two
+ * vector instructions.
+ */
+typedef struct LetterCounts {
+    std::uint8_t counts[32];
+    std::uint32_t mask;
+    int blanks;  // Blank tiles, which can stand for any letter
+
+    LetterCounts() : mask(0), blanks(0) { for (std::uint8_t& c : counts) c = 0; };
+
+    /**
+     * Histogram of the uppercase letters A-Z in the string, along with
+     * the number of blanks (WILDCARD or WILDCARD_ALIAS).
+     * Any other character is ignored.
+     */
+    static LetterCounts of(const std::string& letters);
+
+    /**
+     * Whether or not every letter of this histogram is available
+     * in the other one, i.e. counts[i] <= other.counts[i] for all i
+     */
+    bool fitsIn(const LetterCounts& other) const;
+
+    /**
+     * Number of letters of this histogram the other one doesn't have,
+     * i.e. the sum of counts[i] - other.counts[i] where it is positive
+     */
+    int shortfall(const LetterCounts& other) const;
+} letter_counts;
+
+/**
+ * The dictionary stored for scanning with a set of letters.
+ * Words are bucketed by length and every word keeps its letter mask
+ * and histogram, so a word that needs a letter that isn't available
+ * is rejected with a single mask test and the rest with one histogram
+ * comparison.
+ */
+class Lexicon {
+public:
+    Lexicon() {};
+    explicit Lexicon(const std::vector<std::string>& words) { build(words); }
+
+    /**
+     * Builds the lexicon from a list of uppercase words
+     */
+    void build(const std::vector<std::string>& words);
+
+    /**
+     * Retrieves all possible words given the combination of letters.
+     * Every blank among the letters can fill in for one missing letter.
+     * @param letters
+     *          Letters that can be used to make the words
+     * @param min_length
+     *          Shortest word to return
+     * @return Words that can be made from the letters, shortest first
+     */
+    std::vector<std::string> wordsFrom(const std::string& letters, std::size_t min_length = 2) const;
+
+    /**
+     * Number of words in the lexicon
+     */
+    std::size_t size() const { return _words.size(); }
+
+private:
+    /**
+     * Words of the same length with their masks and histograms
+     * stored in separate arrays so the mask scan stays in cache
+     */
+    typedef struct Bucket {
+        std::vector<std::uint32_t> masks;
+        std::vector<LetterCounts> counts;
+        std::vector<std::uint32_t> words;
+    } bucket;
+
+    std::vector<std::string> _words;
+    Bucket _buckets[LEXICON_MAX_LENGTH + 1];
+};
+
+#endif /* LEXICON_H */
@@ -0,0 +1,586 @@
+#include "movegen.h"
+
+#include <array>
+
+TopMoves::TopMoves(std::size_t capacity) : _capacity(capacity), _offered(0) {
+    _heap.reserve(capacity);
+}
+
+/**
+ * Adds the move to the heap, replacing the worst kept move if it is full
+ */
+void TopMoves::push(const Move& m) {
+    if (_heap.size() == _capacity) {
+        std::pop_heap(_heap.begin(), _heap.end(), better);
+        _heap.back().move = m;
+        _heap.back().order = _offered++;
+    }
+    else {
+        _heap.push_back(Ranked{m, _offered++});
+    }
+    std::push_heap(_heap.begin(), _heap.end(), better);
+}
+
+/**
+ * The other list is sorted in the query's scratch, not in a new vector
+ */
+void TopMoves::merge(const TopMoves& other) {
+    Arena& arena = queryArena();
+    ArenaScope scope(arena);
+
+    Ranked* ranked = arena.allocate<Ranked>(other._heap.size());
+    std::copy(other._heap.begin(), other._heap.end(), ranked);
+    std::sort(ranked, ranked + other._heap.size(), better);
+    for (std::size_t idx = 0; idx < other._heap.size(); ++idx) offer(ranked[idx].move);
+}
+
+std::vector<Move> TopMoves::sorted() const {
+    std::vector<Ranked> ranked(_heap);
+    std::sort(ranked.begin(), ranked.end(), better);
+
+    std::vector<Move> moves(ranked.size());
+    for (std::size_t idx = 0; idx < ranked.size(); ++idx) moves[idx] = ranked[idx].move;
+    return moves;
+}
+
+MoveGenerator::MoveGenerator(const Gaddag& gaddag, const LeaveTable* leaves) :
+    _gaddag(gaddag), _leaves(leaves), _callback(nullptr), _keeping_best(false), _best_equity(-std::numeric_limits<double>::infinity()), _floor(nullptr), _leave_bound(0) {
+    for (int c = 0; c < 26; ++c)
+        _letter_points[c] = LETTER_POINTS[c];
+
+    for (int idx = 0; idx < BOARD_AREA; ++idx) {
+        _letter_multiplier[idx] = letterMultiplier(idx);
+        _word_multiplier[idx] = wordMultiplier(idx);
+    }
+}
+
+/**
+ * Points the generator at the board and fills in the anchors for
+ * both directions along with the letters in the rack.
+ * The cross-checks come from the board, and are only computed
+ * here if the board doesn't have them yet.
+ */
+void MoveGenerator::setup(const Board& board, const std::string& letters, const MoveFilter& filter) {
+    STATS(_stats = QueryStats());
+    _filter = filter;
+    _filtered = filter.min_points > 0 || filter.square >= 0 || filter.min_length > 0;
+    _bounded = filter.min_points > 0;
+    _keeping_best = false;
+    _floor = nullptr;
+
+    _board = &board;
+    if (!board.cross_checks_ready) {
+        _computed = board;
+        computeCrossChecks(_computed, _gaddag);
+        _board = &_computed;
+    }
+
+    _empty_board = boardIsEmpty(board);
+
+    // Empty squares next to a tile are anchors, the first word must go through the middle square
+    if (_empty_board) {
+        int middle = (BOARD_SIZE >> 1) * BOARD_SIZE + (BOARD_SIZE >> 1);
+        _anchors[HORIZONTAL] = _anchors[VERTICAL] = Bitboard();
+        _anchors[HORIZONTAL].set(middle);
+        _anchors[VERTICAL].set(middle);
+    }
+    else {
+        _anchors[HORIZONTAL] = Board::anchors(board.occupied);
+        _anchors[VERTICAL] = Board::anchors(board.occupied_transposed);
+    }
+
+    std::fill(_rack, _rack + 26, 0);
+    _rack_mask = 0;
+    _blanks = 0;
+    for (char c : letters) {
+        if (c == WILDCARD || c == WILDCARD_ALIAS) { ++_blanks; continue; }
+        c = (char) std::toupper(c);
+        if (c < 'A' || c > 'Z') continue;
+        ++_rack[c - 'A'];
+        _rack_mask |= 1u << (c - 'A');
+    }
+
+    _tiles_in_rack = _blanks;
+    for (int c = 0; c < 26; ++c) _tiles_in_rack += _rack[c];
+    _tiles_in_rack = std::min(_tiles_in_rack, BOARD_SIZE);
+
+    if (_bounded) computeTopSums();
+}
+
+/**
+ * Adds up the best tiles of the rack for the bounds on what a word can score
+ */
+void MoveGenerator::computeTopSums() {
+    // Values of the best RACK_SIZE letters from best to worst, blanks are worth nothing.
+    // Each letter is inserted in order and the worst one drops off the end.
+    std::array<int, RACK_SIZE> values;
+    values.fill(0);
+    int letters = 0;
+    for (int c = 0; c < 26; ++c) {
+        for (int copies = 0; copies < _rack[c]; ++copies, ++letters) {
+            int value = _letter_points[c];
+            for (int& kept : values) {
+                if (value > kept) std::swap(value, kept);
+            }
+        }
+    }
+
+    // Letters past the first RACK_SIZE of a longer rack are worth no more than the last one kept
+    for (int left = 0; left <= _tiles_in_rack; ++left) {
+        _top_sum[left][0] = 0;
+        for (int k = 1; k <= (BOARD_SIZE << 1); ++k) {
+            int value = 0;
+            if (k <= left && k <= letters) value = (k <= RACK_SIZE) ? values[k - 1] : values.back();
+            _top_sum[left][k] = _top_sum[left][k - 1] + value;
+        }
+    }
+}
+
+/**
+ * Keeps only the best move from now on, and works out the best leave
+ * the rack can end up with so the bound on points is one on equity
+ */
+void MoveGenerator::startBest(std::atomic<double>* floor) {
+    _keeping_best = true;
+    _bounded = true;
+    _floor = floor;
+    // Any legal move beats passing, even one whose leave costs more than it scores
+    _best = Move();
+    _best_equity = -std::numeric_limits<double>::infinity();
+    computeTopSums();
+
+    _leave_bound = 0;
+    if (_leaves) {
+        int leave[26] = {0};
+        _leave_bound = bestLeave(0, leave, 0);
+    }
+}
+
+/**
+ * Highest equity of the leaves made of the letters from the given one
+ * on, along with the tiles already chosen. At least one tile is played.
+ */
+float MoveGenerator::bestLeave(int letter, int leave[26], int tiles) const {
+    if (letter == 26) {
+        float most = -1e30f;
+        for (int blanks = 0; blanks <= _blanks && tiles + blanks < _tiles_in_rack; ++blanks)
+            most = std::max(most, _leaves->value(leave, blanks));
+        return most;
+    }
+
+    float most = -1e30f;
+    for (leave[letter] = 0; leave[letter] <= _rack[letter]; ++leave[letter])
+        most = std::max(most, bestLeave(letter + 1, leave, tiles + leave[letter]));
+    leave[letter] = 0;
+    return most;
+}
+
+void MoveGenerator::generate(const Board& board, const std::string& letters, const MoveCallback& callback) {
+    _callback = &callback;
+    setup(board, letters);
+    generateBoard();
+    _callback = nullptr;
+}
+
+void MoveGenerator::generate(const Board& board, const std::string& letters, int direction, int line, const MoveCallback& callback) {
+    _callback = &callback;
+    setup(board, letters);
+
+    // Vertical first moves are skipped just like for the whole board
+    if (direction == HORIZONTAL || !_empty_board)
+        generateLine(direction, line);
+    _callback = nullptr;
+}
+
+Move MoveGenerator::best(const Board& board, const std::string& letters) {
+    setup(board, letters);
+    startBest(nullptr);
+    generateBoard();
+    _keeping_best = false;
+    return _best;
+}
+
+Move MoveGenerator::best(const Board& board, const std::string& letters, int direction, int line, std::atomic<double>* floor) {
+    setup(board, letters);
+    startBest(floor);
+    if (direction == HORIZONTAL || !_empty_board)
+        generateLine(direction, line);
+    _keeping_best = false;
+    _floor = nullptr;
+    return _best;
+}
+
+/**
+ * Generates moves in both directions from every anchor on the board
+ */
+void MoveGenerator::generateBoard() {
+    for (int line = 0; line < BOARD_SIZE; ++line)
+        generateLine(HORIZONTAL, line);
+
+    // The board is symmetric, so the vertical first moves are the same as the horizontal ones
+    if (!_empty_board) {
+        for (int line = 0; line < BOARD_SIZE; ++line)
+            generateLine(VERTICAL, line);
+    }
+}
+
+/**
+ * Generates every move on a single row or column
+ */
+void MoveGenerator::generateLine(int direction, int line) {
+    if (!lineCovers(direction, line)) return;
+    selectLine(direction, line);
+
+    for (int pos = 0; pos < BOARD_SIZE; ++pos) {
+        if (isAnchor(pos)) generateAnchor(pos);
+    }
+}
+
+/**
+ * Points the search at a row or column of the board
+ */
+void MoveGenerator::selectLine(int direction, int line) {
+    _direction = direction;
+    _line_number = line;
+    _line = ((direction == HORIZONTAL) ? _board->letters : _board->transposed) + line * BOARD_SIZE;
+    _line_cross_checks = _board->cross_checks[direction] + line * BOARD_SIZE;
+    _line_cross_points = _board->cross_points[direction] + line * BOARD_SIZE;
+    _line_summed = false;
+    std::fill(_right_ready, _right_ready + BOARD_SIZE + 1, 0u);
+}
+
+/**
+ * Adds up what the squares of the current line add to a word, the
+ * first time a word on the line is checked against it. The tiles on
+ * the board are counted at their full value, blanks included, which
+ * keeps the sums an upper bound.
+ */
+void MoveGenerator::sumLine() {
+    _line_summed = true;
+    Reach sum = {0, 0, 0, {0, 0, 0}, 0, 0, 0, 0};
+    for (int pos = 0; pos < BOARD_SIZE; ++pos) {
+        _sums[pos] = sum;
+        int letter = square(pos);
+        if (letter >= 0) {
+            sum.points += _letter_points[letter];
+            continue;
+        }
+
+        // No square has both a letter and a word multiplier, so no multiplier is above 3
+        int idx = boardIndex(pos);
+        _empty_at[sum.empties++] = pos;
+        sum.doubles += _letter_multiplier[idx] >= 2;
+        sum.triples += _letter_multiplier[idx] >= 3;
+        sum.double_words += _word_multiplier[idx] == 2;
+        sum.triple_words += _word_multiplier[idx] == 3;
+        if (_line_cross_points[pos] >= 0) {
+            int multiplier = _letter_multiplier[idx] * _word_multiplier[idx];
+            sum.perpendicular += _line_cross_points[pos] * _word_multiplier[idx];
+            ++sum.crosses[0];
+            sum.crosses[1] += multiplier >= 2;
+            sum.crosses[2] += multiplier >= 3;
+        }
+    }
+    _sums[BOARD_SIZE] = sum;
+}
+
+/**
+ * What the squares from begin up to end (not included) add to a word
+ */
+MoveGenerator::Reach MoveGenerator::stretch(int begin, int end) const {
+    const Reach& last = _sums[end];
+    const Reach& first = _sums[begin];
+    Reach between;
+    between.empties = last.empties - first.empties;
+    between.doubles = last.doubles - first.doubles;
+    between.triples = last.triples - first.triples;
+    for (int idx = 0; idx < 3; ++idx) between.crosses[idx] = last.crosses[idx] - first.crosses[idx];
+    between.points = last.points - first.points;
+    between.double_words = last.double_words - first.double_words;
+    between.triple_words = last.triple_words - first.triple_words;
+    between.perpendicular = last.perpendicular - first.perpendicular;
+    return between;
+}
+
+/**
+ * First square a word can reach going left from the given position
+ * with the given number of tiles, the one after the empty square
+ * that would need one tile too many
+ */
+int MoveGenerator::leftmost(int first, int left) const {
+    int over = _sums[first + 1].empties - left - 1;
+    return (over >= 0) ? _empty_at[over] + 1 : 0;
+}
+
+/**
+ * End of what a word can reach going right from the given position
+ * with the given number of tiles, the empty square that would need
+ * one tile too many
+ */
+int MoveGenerator::rightmost(int first, int left) const {
+    int over = _sums[first].empties + left;
+    return (over < _sums[BOARD_SIZE].empties) ? _empty_at[over] : BOARD_SIZE;
+}
+
+/**
+ * The best tiles of the rack go on the squares with the biggest
+ * multipliers: counting the k best tiles once for every multiplier of
+ * at least 1, 2 and 3 that k squares have is the most they can add.
+ * The words along and across are bounded apart from each other.
+ */
+MoveGenerator::Bound MoveGenerator::combine(const Reach& ahead, const Reach& after, int left) const {
+    const int* best = _top_sum[left];
+    Bound most;
+    most.points = ahead.points + after.points + best[ahead.empties + after.empties]
+        + best[ahead.doubles + after.doubles] + best[ahead.triples + after.triples];
+    most.word_multiplier = 1 << (ahead.double_words + after.double_words);
+    for (int triple = ahead.triple_words + after.triple_words; triple > 0; --triple) most.word_multiplier *= 3;
+    most.cross_points = ahead.perpendicular + after.perpendicular + best[ahead.crosses[0] + after.crosses[0]]
+        + best[ahead.crosses[1] + after.crosses[1]] + best[ahead.crosses[2] + after.crosses[2]];
+
+    // Every tile of a full rack can still be played
+    if (_tiles_in_rack - left + std::min(left, ahead.empties + after.empties) >= RACK_SIZE)
+        most.cross_points += BINGO_BONUS;
+    return most;
+}
+
+/**
+ * Generates every move through an anchor of the current line, unless
+ * the square the filter asks for is too far away to be reached
+ */
+void MoveGenerator::generateAnchor(int pos) {
+    if (_filter.square >= 0) {
+        int along = (_direction == HORIZONTAL) ? _filter.square % BOARD_SIZE : _filter.square / BOARD_SIZE;
+        if (std::abs(along - pos) >= _filter.max_length) return;
+    }
+
+    _anchor = pos;
+    _left_end = std::max(0, pos - _filter.max_length + 1);
+
+    _left_ready = 0;
+    gen(pos, _gaddag.root(), 0, 1, 0, 0);
+}
+
+/**
+ * Whether or not the line holds the square the filter asks for
+ */
+bool MoveGenerator::lineCovers(int direction, int line) const {
+    if (_filter.square < 0) return true;
+    return line == ((direction == HORIZONTAL) ? _filter.square / BOARD_SIZE : _filter.square % BOARD_SIZE);
+}
+
+/**
+ * Places the letter on the board at the given position, or each
+ * possible letter from the rack if the square is empty
+ */
+void MoveGenerator::gen(int pos, Gaddag::node_t node, int main_points, int word_multiplier, int cross_points, int tiles) {
+    int letter = square(pos);
+    if (letter >= 0) {
+        if (_bounded && !canBeat(pos, main_points, word_multiplier, cross_points, tiles)) {
+            STATS(++_stats.pruned);
+            return;
+        }
+
+        STATS(++_stats.lookups);
+        bool blank = _board->blanks.test(boardIndex(pos));
+        goOn(pos, (char) ((blank ? 'a' : 'A') + letter), _gaddag.next(node, letter),
+             main_points + (blank ? 0 : _letter_points[letter]), word_multiplier, cross_points, tiles);
+        return;
+    }
+
+    std::uint32_t available = _gaddag.letters(node) & (_blanks ? ALL_LETTERS : _rack_mask);
+    std::uint32_t allowed = _line_cross_checks[pos] & available;
+    STATS(_stats.rejected += popcount32(available & ~allowed));
+    if (!allowed) return;
+
+    // Only squares where a word can go on are worth bounding
+    if (_bounded && !canBeat(pos, main_points, word_multiplier, cross_points, tiles)) {
+        STATS(++_stats.pruned);
+        return;
+    }
+
+    int idx = boardIndex(pos);
+    int letter_multiplier = _letter_multiplier[idx];
+    int square_multiplier = _word_multiplier[idx];
+    int perpendicular = _line_cross_points[pos];
+
+    while (allowed) {
+        int c = lowestBit32(allowed);
+        allowed &= allowed - 1;
+        Gaddag::node_t child = _gaddag.next(node, c);
+        STATS(++_stats.lookups);
+
+        if (_rack[c]) {
+            if (--_rack[c] == 0) _rack_mask &= ~(1u << c);
+
+            int points = _letter_points[c] * letter_multiplier;
+            int new_cross = cross_points;
+            if (perpendicular >= 0) new_cross += (perpendicular + points) * square_multiplier;
+
+            goOn(pos, (char) ('A' + c), child, main_points + points,
+                 word_multiplier * square_multiplier, new_cross, tiles + 1);
+
+            if (_rack[c]++ == 0) _rack_mask |= 1u << c;
+        }
+
+        // The same letter from a blank, which only adds the word multiplier
+        if (_blanks) {
+            --_blanks;
+            int new_cross = cross_points;
+            if (perpendicular >= 0) new_cross += perpendicular * square_multiplier;
+
+            goOn(pos, (char) ('a' + c), child, main_points,
+                 word_multiplier * square_multiplier, new_cross, tiles + 1);
+            ++_blanks;
+        }
+    }
+}
+
+/**
+ * Continues a word after a letter has been placed at the given position.
+ * Going left, the word may stop, keep going left, or switch to the
+ * right of the anchor. Going right, the word may stop or keep going.
+ */
+void MoveGenerator::goOn(int pos, char tile, Gaddag::node_t node, int main_points, int word_multiplier, int cross_points, int tiles) {
+    _word[pos] = tile;
+
+    if (pos <= _anchor) {
+        bool left_free = pos == 0 || square(pos - 1) < 0;
+        bool right_free = _anchor + 1 == BOARD_SIZE || square(_anchor + 1) < 0;
+        Gaddag::node_t separator = _gaddag.next(node, GADDAG_SEPARATOR);
+        STATS(++_stats.lookups);
+
+        if (left_free && right_free && _gaddag.isTerminal(separator))
+            record(pos, _anchor, main_points, word_multiplier, cross_points, tiles);
+
+        if (node == Gaddag::NO_NODE) return;
+
+        // Tiles can't be placed on an earlier anchor, those moves are found from that anchor
+        if (pos > _left_end && !(left_free && isAnchor(pos - 1)))
+            gen(pos - 1, node, main_points, word_multiplier, cross_points, tiles);
+
+        // The word may not run past the end of the line, or grow longer than the filter allows
+        int right_end = std::min(BOARD_SIZE - 1, pos + _filter.max_length - 1);
+        if (separator != Gaddag::NO_NODE && left_free && _anchor < right_end) {
+            _start = pos;
+            _right_end = right_end;
+            gen(_anchor + 1, separator, main_points, word_multiplier, cross_points, tiles);
+        }
+    }
+    else {
+        bool right_free = pos + 1 == BOARD_SIZE || square(pos + 1) < 0;
+
+        if (right_free && _gaddag.isTerminal(node))
+            record(_start, pos, main_points, word_multiplier, cross_points, tiles);
+
+        if (node != Gaddag::NO_NODE && pos < _right_end)
+            gen(pos + 1, node, main_points, word_multiplier, cross_points, tiles);
+    }
+}
+
+/**
+ * Builds the move spanning the given positions and hands it to the callback
+ */
+void MoveGenerator::record(int start, int end, int main_points, int word_multiplier, int cross_points, int tiles) {
+    STATS(++_stats.words);
+    if (end == start || tiles == 0) return;
+
+    // A single tile that makes words both ways is already found horizontally
+    if (_direction == VERTICAL && tiles == 1 && _line_cross_points[_anchor] >= 0) return;
+
+    int points = main_points * word_multiplier + cross_points;
+    if (tiles == RACK_SIZE) points += BINGO_BONUS;
+
+    // Moves that can't beat the best move aren't built either
+    if (_keeping_best && (double) points + _leave_bound <= _best_equity) return;
+
+    // Moves the filter turns away are never built
+    if (_filtered) {
+        if (end - start + 1 < _filter.min_length || (std::size_t) points < _filter.min_points) return;
+        if (_filter.square >= 0) {
+            int along = (_direction == HORIZONTAL) ? _filter.square % BOARD_SIZE : _filter.square / BOARD_SIZE;
+            if (along < start || along > end) return;
+        }
+    }
+
+    Move move;
+    move.direction = _direction;
+    move.anchorX = (_direction == HORIZONTAL) ? start : _line_number;
+    move.anchorY = (_direction == HORIZONTAL) ? _line_number : start;
+    move.points = points;
+
+    // The tiles of the move are off the rack while the word is being built
+    if (_leaves) move.leave = _leaves->value(_rack, _rack_mask, _blanks);
+
+    move.word.assign(_word + start, _word + end + 1);
+
+    STATS(++_stats.placements);
+    if (_keeping_best) keep(move);
+    else (*_callback)(move);
+}
+
+/**
+ * Keeps the move if it is better than the best one so far,
+ * and raises the floor shared with the other lines
+ */
+void MoveGenerator::keep(const Move& move) {
+    double equity = move.equity();
+    if (equity <= _best_equity) return;
+    _best = move;
+    _best_equity = equity;
+
+    if (!_floor) return;
+    double seen = _floor->load(std::memory_order_relaxed);
+    while (seen < equity && !_floor->compare_exchange_weak(seen, equity, std::memory_order_relaxed)) {}
+}
+
+MoveEnumerator::MoveEnumerator(const Gaddag& gaddag, const Board& board, const std::string& letters,
+                               const MoveFilter& filter, const LeaveTable* leaves) :
+    _generator(gaddag, leaves), _taken(0), _direction(HORIZONTAL), _line(0), _pos(0) {
+    _collect = [this](const Move& m) { _pending.push_back(m); };
+    _generator.setup(board, letters, filter);
+    _generator._callback = &_collect;
+}
+
+bool MoveEnumerator::next(Move& move) {
+    while (_taken == _pending.size()) {
+        if (!advance()) return false;
+    }
+    move = _pending[_taken++];
+    return true;
+}
+
+/**
+ * Generates the moves of the next anchor, walking the anchors in the
+ * same order as MoveGenerator::generate
+ * @return False once there are no anchors left
+ */
+bool MoveEnumerator::advance() {
+    _pending.clear();
+    _taken = 0;
+
+    for (;;) {
+        if (_line == BOARD_SIZE) {
+            // The board is symmetric, so the vertical first moves are the same as the horizontal ones
+            if (_direction == VERTICAL || _generator._empty_board) return false;
+            _direction = VERTICAL;
+            _line = 0;
+        }
+
+        if (_pos == 0 && !_generator.lineCovers(_direction, _line)) {
+            ++_line;
+            continue;
+        }
+        if (_pos == 0) _generator.selectLine(_direction, _line);
+
+        while (_pos < BOARD_SIZE && !_generator.isAnchor(_pos)) ++_pos;
+        if (_pos == BOARD_SIZE) {
+            _pos = 0;
+            ++_line;
+            continue;
+        }
+
+        _generator.generateAnchor(_pos++);
+        return true;
+    }
+}
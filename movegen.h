@@ -0,0 +1,435 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+#include "board.h"
+#include "gaddag.h"
+#include "leaves.h"
+#include "stats.h"
+
+/**
+ * Called once for every legal move found by the generator
+ */
+typedef std::function<void(const Move&)> MoveCallback;
+
+/**
+ * Limits on the moves a generator hands out. They are checked while
+ * the words are being built, so lines, anchors and longer words that
+ * can't pass are never searched, and a move that fails is dropped
+ * before it is put together.
+ * Defaults: Every move passes
+ */
+typedef struct MoveFilter {
+    std::size_t min_points;     // Fewest points a move may score
+    int square;                 // Board index (y * BOARD_SIZE + x) the word must cover, -1 for anywhere
+    int min_length, max_length; // Fewest and most letters in the word, tiles already on the board included
+
+    MoveFilter() : min_points(0), square(-1), min_length(0), max_length(BOARD_SIZE) {};
+} move_filter;
+
+/**
+ * Keeps the best K of all the moves it is offered in a fixed-size
+ * min-heap, so the worst kept move is always on top and a move that
+ * can't make the list is turned away with a single comparison.
+ * Moves are ranked by equity (points plus leave), and moves with the
+ * same equity in the order they were offered.
+ * Nothing is allocated once the heap is full.
+ */
+class TopMoves {
+public:
+    /**
+     * @param capacity
+     *          Number of moves to keep
+     */
+    explicit TopMoves(std::size_t capacity);
+
+    /**
+     * Keeps the move if it is one of the best so far
+     */
+    void offer(const Move& m) {
+        if (_heap.size() == _capacity && (_capacity == 0 || m.equity() <= _heap.front().move.equity())) {
+            ++_offered;
+            return;
+        }
+        push(m);
+    }
+
+    /**
+     * Offers every kept move of another list, best first
+     */
+    void merge(const TopMoves& other);
+
+    /**
+     * Kept moves from best to worst
+     */
+    std::vector<Move> sorted() const;
+
+private:
+    typedef struct Ranked {
+        Move move;
+        std::size_t order;  // Number of moves offered before this one
+    } ranked;
+
+    static bool better(const Ranked& a, const Ranked& b) {
+        return a.move.equity() > b.move.equity() || (a.move.equity() == b.move.equity() && a.order < b.order);
+    }
+
+    void push(const Move& m);
+
+    std::size_t _capacity;
+    std::size_t _offered;
+    std::vector<Ranked> _heap;
+};
+
+/**
+ * Exhaustive move generator driven by a GADDAG.
+ *
+ * Every empty square that touches a tile on the board is an anchor
+ * (only the middle square on an empty board). Words are grown outwards
+ * from each anchor, first to the left (or up) and then to the right
+ * (or down), following the GADDAG so that only prefixes of real words
+ * are ever explored. Letters placed next to existing tiles are limited
+ * by cross-checks so every perpendicular word is valid as well.
+ *
+ * The points of each move are computed while the word is being built,
+ * including bonus tiles and the points of any perpendicular words.
+ *
+ * A blank in the rack (WILDCARD or WILDCARD_ALIAS) is tried as every
+ * letter the GADDAG and the cross-checks allow on a square, next to the
+ * real tile of that letter if there is one. It is written lowercase in
+ * the word of the move and scores nothing.
+ *
+ * With a leave table, every move also carries the equity of the tiles
+ * it leaves on the rack, looked up from what is left of the rack.
+ *
+ * When only the best move is wanted, the most a partial word could
+ * still score is worked out before it is grown any further: the best
+ * tile left on the rack on every square the remaining tiles can reach,
+ * with the bonus squares and the words made across those squares, plus
+ * the tiles already on the board. Anchors and partial words that can't
+ * beat the best move found so far are cut off.
+ */
+class MoveGenerator {
+public:
+    /**
+     * @param gaddag
+     *          GADDAG of the Scrabble dictionary
+     * @param leaves
+     *          Equity of the tiles left on the rack, if not null
+     */
+    explicit MoveGenerator(const Gaddag& gaddag, const LeaveTable* leaves = nullptr);
+
+    /**
+     * Generates every legal move on the board
+     * @param board
+     *          State of the Scrabble board
+     * @param letters
+     *          Letters in the hands of the user
+     * @param callback
+     *          Called with every legal move
+     */
+    void generate(const Board& board, const std::string& letters, const MoveCallback& callback);
+
+    /**
+     * Generates the legal moves of a single row or column, in the same
+     * order they come in when the whole board is generated.
+     * Every line of the board can be searched on its own, so the lines
+     * can be split between several generators.
+     * @param board
+     *          State of the Scrabble board
+     * @param letters
+     *          Letters in the hands of the user
+     * @param direction
+     *          HORIZONTAL for a row, VERTICAL for a column
+     * @param line
+     *          Index of the row or column
+     * @param callback
+     *          Called with every legal move
+     */
+    void generate(const Board& board, const std::string& letters, int direction, int line, const MoveCallback& callback);
+
+    /**
+     * Finds the move with the highest equity, the first one generated on
+     * ties, which is the move a search of every move would keep
+     * @param board
+     *          State of the Scrabble board
+     * @param letters
+     *          Letters in the hands of the user
+     * @return The best move, a null move only if there is no legal move
+     */
+    Move best(const Board& board, const std::string& letters);
+
+    /**
+     * Finds the best move of a single row or column
+     * @param board
+     *          State of the Scrabble board
+     * @param letters
+     *          Letters in the hands of the user
+     * @param direction
+     *          HORIZONTAL for a row, VERTICAL for a column
+     * @param line
+     *          Index of the row or column
+     * @param floor
+     *          Highest equity found so far by the searches of the other
+     *          lines, if not null. It is raised by this search and words
+     *          that must score less are cut off, so a move that ties it is
+     *          still found.
+     * @return The best move of the line, a worse one or a null move if another line has a better move
+     */
+    Move best(const Board& board, const std::string& letters, int direction, int line, std::atomic<double>* floor);
+
+    /**
+     * Words, placements, cross-check rejections, lookups and pruned words
+     * counted by the last search (only when QUERY_STATS is on)
+     */
+    const QueryStats& stats() const { return _stats; }
+
+private:
+    friend class MoveEnumerator;
+
+    void setup(const Board& board, const std::string& letters, const MoveFilter& filter = MoveFilter());
+    void startBest(std::atomic<double>* floor);
+    void computeTopSums();
+    void generateBoard();
+    void generateLine(int direction, int line);
+    void selectLine(int direction, int line);
+    void sumLine();
+    void generateAnchor(int pos);
+    bool lineCovers(int direction, int line) const;
+    void gen(int pos, Gaddag::node_t node, int main_points, int word_multiplier, int cross_points, int tiles);
+    void goOn(int pos, char tile, Gaddag::node_t node, int main_points, int word_multiplier, int cross_points, int tiles);
+    void record(int start, int end, int main_points, int word_multiplier, int cross_points, int tiles);
+    void keep(const Move& move);
+
+    /**
+     * What a stretch of a line can add to a word: its empty squares
+     * and their multipliers, and the tiles already on the board
+     */
+    typedef struct Reach {
+        int empties;                // Empty squares
+        int doubles, triples;       // Empty squares with a letter multiplier of at least 2 and of 3
+        int crosses[3];             // Empty squares with a word across, whose letter times word multiplier is at least 1, 2 and 3
+        int points;                 // Points of the tiles already on the board
+        int double_words;           // Empty squares doubling the word
+        int triple_words;           // Empty squares tripling the word
+        int perpendicular;          // Words made across the empty squares, with their word multipliers
+    } reach;
+
+    Reach stretch(int begin, int end) const;
+    int leftmost(int first, int left) const;
+    int rightmost(int first, int left) const;
+    float bestLeave(int letter, int leave[26], int tiles) const;
+
+    /**
+     * Most that the squares still ahead of a word can add to it: the
+     * points along it before its word multiplier, the word multiplier,
+     * and the points across it along with the bingo bonus
+     */
+    typedef struct Bound {
+        int points;
+        int word_multiplier;
+        int cross_points;
+    } bound;
+
+    Bound combine(const Reach& ahead, const Reach& after, int left) const;
+
+    /**
+     * Most a word can still gain going left from a position up to the
+     * anchor, and then right of the anchor, worked out the first time
+     * it is asked for
+     */
+    const Bound& boundLeft(int pos, int left) {
+        if (!(_left_ready >> pos & 1)) {
+            if (!_line_summed) sumLine();
+            _bound_left[pos] = combine(stretch(leftmost(pos, left), pos + 1),
+                stretch(_anchor + 1, rightmost(_anchor + 1, left)), left);
+            _left_ready |= 1u << pos;
+        }
+        return _bound_left[pos];
+    }
+
+    /**
+     * Most a word can still gain going right from a position
+     */
+    const Bound& boundRight(int pos, int left) {
+        if (!(_right_ready[pos] >> left & 1)) {
+            if (!_line_summed) sumLine();
+            _bound_right[pos][left] = combine(stretch(pos, rightmost(pos, left)), _sums[0], left);
+            _right_ready[pos] |= 1u << left;
+        }
+        return _bound_right[pos][left];
+    }
+
+    /**
+     * Whether or not the words grown from the given position could still
+     * score enough to beat the best move, or to pass the filter
+     */
+    bool canBeat(int pos, int main_points, int word_multiplier, int cross_points, int tiles) {
+        int left = _tiles_in_rack - tiles;
+        const Bound& most = (pos <= _anchor) ? boundLeft(pos, left) : boundRight(pos, left);
+        int bound = (main_points + most.points) * word_multiplier * most.word_multiplier + cross_points + most.cross_points;
+
+        if ((std::size_t) bound < _filter.min_points) return false;
+        if (!_keeping_best) return true;
+
+        double equity = (double) bound + _leave_bound;
+        return equity > _best_equity && !(_floor && equity < _floor->load(std::memory_order_relaxed));
+    }
+
+    /**
+     * Letter index of the tile at the given position on the line, -1 if it is empty
+     */
+    int square(int pos) const {
+        char c = _line[pos];
+        return (c >= 'A' && c <= 'Z') ? c - 'A' : -1;
+    }
+
+    /**
+     * Whether or not the given position on the line is an anchor
+     */
+    bool isAnchor(int pos) const { return _anchors[_direction].test(_line_number * BOARD_SIZE + pos); }
+
+    /**
+     * Board index (y * BOARD_SIZE + x) of the given position on a line
+     */
+    int boardIndex(int pos) const {
+        return (_direction == HORIZONTAL) ? _line_number * BOARD_SIZE + pos : pos * BOARD_SIZE + _line_number;
+    }
+
+    const Gaddag& _gaddag;
+    const LeaveTable* _leaves;
+    const MoveCallback* _callback;
+    MoveFilter _filter;
+    bool _filtered;             // Whether or not the filter turns any finished word away
+    bool _bounded;              // Whether or not partial words are checked against the most they can score
+    QueryStats _stats;
+
+    // Best move so far when only the best move is wanted
+    bool _keeping_best;
+    Move _best;
+    double _best_equity;
+    std::atomic<double>* _floor;
+    float _leave_bound;         // Highest equity of any leave of the rack
+
+    // Point value of every letter index
+    int _letter_points[26];
+
+    // Letter and word multipliers by board index
+    int _letter_multiplier[BOARD_AREA];
+    int _word_multiplier[BOARD_AREA];
+
+    /**
+     * Board being searched. Its letters, cross-checks and cross points
+     * are already stored line by line for both directions (the letters
+     * of the columns in "transposed"), so a row and a column are walked
+     * the same way without copying anything.
+     * A local copy is only made when the board has no cross-checks yet.
+     */
+    const Board* _board;
+    Board _computed;
+    Bitboard _anchors[2];
+    bool _empty_board;
+
+    // Letters in the user's hand, blanks are counted apart from the letters
+    int _rack[26];
+    std::uint32_t _rack_mask;
+    int _blanks;
+    int _tiles_in_rack;         // Letters and blanks, no more than a line can take
+
+    // Points of the best k tiles in the rack, with no more than the given number of tiles left.
+    // Any k of the tiles left are worth no more than that.
+    int _top_sum[BOARD_SIZE + 1][(BOARD_SIZE << 1) + 1];
+
+    // Line currently being searched
+    int _direction;
+    int _line_number;
+    int _anchor;
+    int _start;
+    int _left_end, _right_end;  // Furthest the word may reach from the anchor, the end of the line without a filter
+    const char* _line;
+    const std::uint32_t* _line_cross_checks;
+    const std::int16_t* _line_cross_points;
+    char _word[BOARD_SIZE];
+
+    // Sums of what the squares of the current line before each position add
+    // to a word (_sums[0] adds nothing), and the positions of its empty squares
+    Reach _sums[BOARD_SIZE + 1];
+    int _empty_at[BOARD_SIZE];
+    bool _line_summed;
+
+    // Most a word can still gain from each position with each number of tiles left going
+    // right, and going left from the current anchor and then right of it. Going left, the
+    // squares up to the anchor are all filled, so the tiles left are known from the position.
+    // Each bound is only worked out when a word first needs it, the bits say which ones are.
+    Bound _bound_left[BOARD_SIZE];
+    Bound _bound_right[BOARD_SIZE + 1][BOARD_SIZE + 1];
+    std::uint32_t _left_ready;
+    std::uint32_t _right_ready[BOARD_SIZE + 1];
+};
+
+/**
+ * Legal moves handed out one at a time, for callers that want to look
+ * at the moves as they are found or stop once one is good enough.
+ *
+ * The moves come in the same order as MoveGenerator::generate, but only
+ * the moves of one anchor are generated at a time, when the ones before
+ * them have all been taken. Stopping early skips the rest of the board.
+ * The board must not change while its moves are being enumerated.
+ */
+class MoveEnumerator {
+public:
+    /**
+     * @param gaddag
+     *          GADDAG of the Scrabble dictionary
+     * @param board
+     *          State of the Scrabble board
+     * @param letters
+     *          Letters in the hands of the user
+     * @param filter
+     *          Moves that are handed out, every move by default
+     * @param leaves
+     *          Equity of the tiles left on the rack, if not null
+     */
+    MoveEnumerator(const Gaddag& gaddag, const Board& board, const std::string& letters,
+                   const MoveFilter& filter = MoveFilter(), const LeaveTable* leaves = nullptr);
+
+    MoveEnumerator(const MoveEnumerator&) = delete;
+    MoveEnumerator& operator=(const MoveEnumerator&) = delete;
+
+    /**
+     * Finds the next move that passes the filter
+     * @param move
+     *          Set to the move
+     * @return False once every move has been handed out
+     */
+    bool next(Move& move);
+
+    /**
+     * What the generator did for the moves handed out so far (only when QUERY_STATS is on)
+     */
+    const QueryStats& stats() const { return _generator.stats(); }
+
+private:
+    bool advance();
+
+    MoveGenerator _generator;
+    MoveCallback _collect;
+
+    // Moves of the current anchor, and how many of them were handed out
+    std::vector<Move> _pending;
+    std::size_t _taken;
+
+    // Next anchor to generate
+    int _direction;
+    int _line;
+    int _pos;
+};
+
+#endif /* MOVEGEN_H */
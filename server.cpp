@@ -0,0 +1,125 @@
+#include "server.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+std::string answerRequest(const Solver& solver, const std::string& line) {
+    if (line == "STATS") {
+        CacheStats cache = solver.cacheStats();
+        std::ostringstream answer;
+        answer << "CACHE " << cache.hits << ' ' << cache.misses << ' ' << cache.evictions << ' ' << cache.entries << '\n';
+        return answer.str();
+    }
+
+    Board board;
+    std::string rack;
+    if (!parsePosition(line, board, rack)) return "ERROR expected a rack and 225 squares\n";
+
+    std::ostringstream answer;
+    writeMove(answer, solver.findBestWord(board, rack));
+    return answer.str();
+}
+
+void serveStream(const Solver& solver, std::istream& input, std::ostream& output) {
+    std::string _line;
+    while (std::getline(input, _line)) {
+        if (_line.empty() || _line == "\r") continue;
+        output << answerRequest(solver, _line) << std::flush;
+    }
+}
+
+/**
+ * Writes the whole buffer to the socket
+ * @return False if the client went away
+ */
+static bool sendAll(int client, const std::string& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = send(client, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        sent += (std::size_t) written;
+    }
+    return true;
+}
+
+/**
+ * Answers the requests of one client until it disconnects.
+ * Every complete line received is answered, and the answers to the lines
+ * that arrived together are sent back together.
+ */
+static void serveClient(const Solver& solver, int client) {
+    std::string pending, answers;
+    char buffer[SERVER_MAX_LINE];
+
+    for (;;) {
+        ssize_t received = recv(client, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) break;
+        pending.append(buffer, (std::size_t) received);
+
+        std::size_t start = 0, end;
+        while ((end = pending.find('\n', start)) != std::string::npos) {
+            std::string line = pending.substr(start, end - start);
+            if (!line.empty() && line != "\r") answers += answerRequest(solver, line);
+            start = end + 1;
+        }
+        pending.erase(0, start);
+
+        if (!answers.empty() && !sendAll(client, answers)) break;
+        answers.clear();
+
+        if (pending.size() > SERVER_MAX_LINE) {
+            sendAll(client, "ERROR request too long\n");
+            break;
+        }
+    }
+    close(client);
+}
+
+bool serveSocket(const Solver& solver, const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path is empty or too long\n";
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) { std::cerr << "socket: " << std::strerror(errno) << '\n'; return false; }
+
+    // A socket left behind by an earlier server would make bind fail
+    unlink(path.c_str());
+    if (bind(listener, (sockaddr*) &address, sizeof(address)) < 0 || listen(listener, SERVER_BACKLOG) < 0) {
+        std::cerr << path << ": " << std::strerror(errno) << '\n';
+        close(listener);
+        return false;
+    }
+
+    // A client that disconnects before its answer arrives must not end the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    for (;;) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            std::cerr << "accept: " << std::strerror(errno) << '\n';
+            break;
+        }
+        std::thread(serveClient, std::cref(solver), client).detach();
+    }
+
+    close(listener);
+    unlink(path.c_str());
+    return false;
+}
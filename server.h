@@ -0,0 +1,47 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <iostream>
+#include <string>
+
+#include "solver.h"
+
+// Longest request line accepted, a client that sends a longer one is disconnected
+#define SERVER_MAX_LINE 4096
+
+// Connections that can wait to be accepted
+#define SERVER_BACKLOG 64
+
+/**
+ * Answers a single request.
+ * A request is a position on one line (see parsePosition) and the answer
+ * is the best move as written by writeMove, or "ERROR <reason>".
+ * The request "STATS" is answered with the counters of the result cache:
+ * "CACHE <hits> <misses> <evictions> <entries>".
+ * @param solver
+ *          Solver with the dictionary already loaded
+ * @param line
+ *          Request line, without the newline
+ * @return Answer line, with the newline
+ */
+std::string answerRequest(const Solver& solver, const std::string& line);
+
+/**
+ * Answers every request read from the input until it ends, one answer
+ * line per request line, flushed as soon as it is written so the input
+ * and output can be the two ends of a pipe. Empty lines are skipped.
+ */
+void serveStream(const Solver& solver, std::istream& input, std::ostream& output);
+
+/**
+ * Listens on a Unix domain socket and answers the requests of every
+ * client that connects, each client on its own thread. A client may
+ * send any number of requests and gets the answers back in order.
+ * Only returns if the socket can't be set up or stops accepting.
+ * @param path
+ *          Path of the socket, replaced if it already exists
+ * @return False, with the reason written to stderr
+ */
+bool serveSocket(const Solver& solver, const std::string& path);
+
+#endif /* SERVER_H */
@@ -0,0 +1,184 @@
+#include "simulate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "bag.h"
+
+void Candidate::add(double equity) {
+    ++iterations;
+    _sum += equity;
+    _squares += equity * equity;
+
+    mean = _sum / iterations;
+    double variance = (iterations > 1) ? (_squares - _sum * mean) / (iterations - 1) : 0.0;
+    double margin = SIM_CONFIDENCE * std::sqrt(std::max(0.0, variance) / iterations);
+    low = mean - margin;
+    high = mean + margin;
+}
+
+std::string unseenTiles(const Board& board, const std::string& rack) {
+    int counts[27];
+    std::copy(LETTER_TILES, LETTER_TILES + 26, counts);
+    counts[26] = BLANK_TILES;
+
+    for (int idx = 0; idx < BOARD_AREA; ++idx) {
+        if (board.letters[idx] != EMPTY) --counts[board.blanks.test(idx) ? 26 : board.letters[idx] - 'A'];
+    }
+    for (char c : rack) {
+        if (c == WILDCARD || c == WILDCARD_ALIAS) --counts[26];
+        else if (c >= 'A' && c <= 'Z') --counts[c - 'A'];
+    }
+
+    std::string unseen;
+    for (int idx = 0; idx < 27; ++idx)
+        unseen.append((std::size_t) std::max(0, counts[idx]), (idx == 26) ? WILDCARD_ALIAS : (char) ('A' + idx));
+    return unseen;
+}
+
+std::string tilesPlaced(const Board& board, const Move& move) {
+    int dx = (move.direction == HORIZONTAL) ? 1 : 0, dy = 1 - dx;
+    std::string placed;
+    for (std::size_t i = 0; i < move.word.length(); ++i) {
+        if (board.getTile(move.anchorX + (int) i * dx, move.anchorY + (int) i * dy) != EMPTY) continue;
+        char c = move.word[i];
+        placed += (c >= 'a' && c <= 'z') ? WILDCARD_ALIAS : c;
+    }
+    return placed;
+}
+
+/**
+ * Seed of a single game, mixed so that neighbouring games draw unrelated tiles
+ */
+static std::uint64_t gameSeed(std::uint64_t seed, std::size_t candidate, std::size_t game) {
+    return splitMix64(seed ^ ((std::uint64_t) candidate << 40) ^ (std::uint64_t) game);
+}
+
+static std::size_t workerCount(std::size_t threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    return threads ? threads : 1;
+}
+
+Simulator::Simulator(const Solver& solver, std::size_t threads) :
+    _solver(solver), _pool(workerCount(threads)), _boards(_pool.size()) {
+    for (std::size_t idx = 0; idx < _pool.size(); ++idx)
+        _generators.emplace_back(new MoveGenerator(solver.gaddag(), solver.leaves()));
+}
+
+std::vector<Candidate> Simulator::simulate(Board& board, const std::string& rack, const SimOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::milliseconds(options.milliseconds);
+
+    // Blanks are '?' throughout, so the tiles of a move can be taken off the rack
+    std::string hand;
+    for (char c : rack) hand += (c == WILDCARD) ? WILDCARD_ALIAS : (char) std::toupper(c);
+
+    if (!board.cross_checks_ready)
+        computeCrossChecks(board, _solver.gaddag());
+
+    std::vector<Move> moves = _solver.findTopMoves(board, hand, options.candidates);
+    std::vector<Candidate> candidates(moves.size());
+    for (std::size_t idx = 0; idx < moves.size(); ++idx) {
+        Candidate& c = candidates[idx];
+        c.move = moves[idx];
+        c.mean = c.low = c.high = (double) c.move.points;
+        c.leave = hand;
+        for (char tile : tilesPlaced(board, c.move)) c.leave.erase(c.leave.find(tile), 1);
+    }
+
+    std::string unseen = unseenTiles(board, hand);
+    for (std::size_t worker = 0; worker < _boards.size(); ++worker) _boards[worker] = board;
+
+    std::vector<std::size_t> alive;
+    std::vector<double> equities;
+    std::vector<char> played;
+    while (options.plies > 1) {
+        std::size_t remaining = 0;
+        alive.clear();
+        for (std::size_t idx = 0; idx < candidates.size(); ++idx) {
+            if (candidates[idx].dropped) continue;
+            ++remaining;
+            if (candidates[idx].iterations < options.iterations) alive.push_back(idx);
+        }
+        if (remaining <= 1 || alive.empty()) break;
+        if (options.milliseconds && std::chrono::steady_clock::now() >= deadline) break;
+
+        // A round is the next SIM_ROUND games of every candidate still in the running,
+        // interleaved so that a round cut short by the time budget is fair to all of them
+        std::size_t tasks = alive.size() * SIM_ROUND;
+        equities.assign(tasks, 0.0);
+        played.assign(tasks, 0);
+        _pool.run(tasks, [&](std::size_t task, std::size_t worker) {
+            std::size_t idx = alive[task % alive.size()];
+            std::size_t game = candidates[idx].iterations + task / alive.size();
+            if (game >= options.iterations) return;
+            if (options.milliseconds && std::chrono::steady_clock::now() >= deadline) return;
+
+            equities[task] = play(_boards[worker], *_generators[worker], candidates[idx], unseen,
+                                  options.plies, gameSeed(options.seed, idx, game));
+            played[task] = 1;
+        });
+
+        // Added in task order so the means don't depend on which thread played which game
+        for (std::size_t task = 0; task < tasks; ++task) {
+            if (played[task]) candidates[alive[task % alive.size()]].add(equities[task]);
+        }
+
+        // Drop every candidate that is clearly behind the leader
+        Candidate* leader = nullptr;
+        bool enough = true;
+        for (Candidate& c : candidates) {
+            if (c.dropped) continue;
+            enough = enough && c.iterations >= std::min<std::size_t>(SIM_MIN_ITERATIONS, options.iterations);
+            if (!leader || c.mean > leader->mean) leader = &c;
+        }
+        if (!enough) continue;
+        for (Candidate& c : candidates) {
+            if (&c != leader && !c.dropped && c.high < leader->low) c.dropped = true;
+        }
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.mean > b.mean;
+    });
+    return candidates;
+}
+
+/**
+ * Plays one game from the position: the candidate, then the move with the
+ * most equity of each side in turn, with racks refilled from the bag.
+ * The board is back to the position when it returns.
+ * @return Equity of the game for the player
+ */
+double Simulator::play(Board& board, MoveGenerator& generator, const Candidate& candidate,
+                       const std::string& unseen, int plies, std::uint64_t seed) const {
+    TileBag bag(unseen, seed);
+
+    // The opponent's rack is already full, the player draws from what is left after it
+    std::string racks[2];
+    bag.draw(racks[1]);
+    racks[0] = candidate.leave;
+    bag.draw(racks[0]);
+
+    board.apply(candidate.move);
+    int applied = 1;
+    double equity = (double) candidate.move.points;
+
+    for (int ply = 1; ply < plies; ++ply) {
+        std::string& rack = racks[ply & 1];
+        // Only a side without any legal move passes, however bad its leaves
+        Move best = generator.best(board, rack);
+        if (best.word.empty()) continue;
+
+        for (char tile : tilesPlaced(board, best)) rack.erase(rack.find(tile), 1);
+        board.apply(best);
+        ++applied;
+        bag.draw(rack);
+        equity += (ply & 1) ? -(double) best.points : (double) best.points;
+    }
+
+    while (applied--) board.undo();
+    return equity;
+}
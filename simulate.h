@@ -0,0 +1,135 @@
+#ifndef SIMULATE_H
+#define SIMULATE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "movegen.h"
+#include "solver.h"
+#include "threadpool.h"
+
+// Candidate moves simulated, the ones with the most equity
+#define SIM_CANDIDATES 10
+
+// Moves played in each simulated game, the candidate included
+#define SIM_PLIES 3
+
+// Most games simulated for each candidate
+#define SIM_ITERATIONS 5000
+
+// Games simulated for each candidate between checks for an early stop
+#define SIM_ROUND 32
+
+// Games every candidate is simulated before any candidate can be dropped
+#define SIM_MIN_ITERATIONS 64
+
+// Normal quantile of the confidence intervals (95%)
+#define SIM_CONFIDENCE 1.96
+
+/**
+ * Settings of a simulation, every one has a default
+ */
+typedef struct SimOptions {
+    std::size_t candidates;     // Candidate moves simulated
+    int plies;                  // Moves in each simulated game, the candidate included
+    std::size_t iterations;     // Most games simulated for each candidate
+    std::size_t milliseconds;   // Time budget, 0 for none
+    std::uint64_t seed;         // Seed of the tile draws, the same seed draws the same tiles
+
+    SimOptions() : candidates(SIM_CANDIDATES), plies(SIM_PLIES), iterations(SIM_ITERATIONS),
+        milliseconds(0), seed(0) {};
+} sim_options;
+
+/**
+ * A candidate move and what the simulated games made of it.
+ * The equity of a game is the points of the candidate, minus the
+ * points of every reply by the opponent, plus the points of every
+ * later move of the player.
+ */
+typedef struct Candidate {
+    Move move;
+    std::string leave;          // Tiles left on the rack after the move ('?' for a blank)
+    std::size_t iterations;     // Games simulated
+    double mean;                // Mean equity
+    double low, high;           // Confidence interval of the mean equity
+    bool dropped;               // Stopped early, clearly behind the leader
+
+    Candidate() : iterations(0), mean(0), low(0), high(0), dropped(false), _sum(0), _squares(0) {};
+
+    /**
+     * Adds the equity of one game and updates the mean and interval
+     */
+    void add(double equity);
+
+private:
+    double _sum, _squares;
+} candidate;
+
+/**
+ * Tiles not on the board or the rack, which the opponent's rack and
+ * the bag are made of ('?' for a blank)
+ */
+std::string unseenTiles(const Board& board, const std::string& rack);
+
+/**
+ * Tiles the move takes from the rack ('?' for a blank),
+ * given the board before the move
+ */
+std::string tilesPlaced(const Board& board, const Move& move);
+
+/**
+ * Monte Carlo simulation of the best candidate moves.
+ *
+ * Every game draws random tiles from the unseen ones to refill the
+ * player's rack and to make the opponent's rack, and then both sides
+ * play their move with the most equity for the given number of plies.
+ * The games are spread over a pool of threads and are simulated in
+ * rounds. After each round a candidate whose interval is entirely
+ * below the leader's is dropped, and the simulation ends once a single
+ * candidate is left, every candidate has its games, or time is up.
+ *
+ * The tiles drawn in a game only depend on the seed, the candidate
+ * and the number of the game, so without a time budget the result is
+ * the same for any number of threads.
+ */
+class Simulator {
+public:
+    /**
+     * @param solver
+     *          Solver with the dictionary, used to find the candidates
+     * @param threads
+     *          Threads the games are spread over, 0 for one on each core
+     */
+    Simulator(const Solver& solver, std::size_t threads = SOLVER_THREADS);
+
+    Simulator(const Simulator&) = delete;
+    Simulator& operator=(const Simulator&) = delete;
+
+    /**
+     * Simulates the best candidate moves of a position
+     * @param board
+     *          State of the Scrabble board
+     * @param rack
+     *          Letters in the hands of the player
+     * @param options
+     *          Settings of the simulation
+     * @return Candidates from highest to lowest mean equity
+     */
+    std::vector<Candidate> simulate(Board& board, const std::string& rack, const SimOptions& options = SimOptions());
+
+private:
+    double play(Board& board, MoveGenerator& generator, const Candidate& candidate,
+                const std::string& unseen, int plies, std::uint64_t seed) const;
+
+    const Solver& _solver;
+    ThreadPool _pool;
+
+    // Move generator and copy of the board each worker plays its games with
+    std::vector<std::unique_ptr<MoveGenerator> > _generators;
+    std::vector<Board> _boards;
+};
+
+#endif /* SIMULATE_H */
@@ -0,0 +1,162 @@
+#include "solver.h"
+
+Solver::Solver(std::size_t threads) {
+    load(DICTIONARY_IMAGE, DICTIONARY);
+    startThreads(threads);
+}
+
+Solver::Solver(const std::string& image, const std::string& dictionary, std::size_t threads) {
+    load(image, dictionary);
+    startThreads(threads);
+}
+
+/**
+ * Maps the image if there is one, otherwise builds the GADDAG from
+ * the text dictionary. Anything else the search method needs is
+ * derived from the GADDAG here so no query has to do it.
+ */
+void Solver::load(const std::string& image, const std::string& dictionary) {
+    if (image.empty() || !_gaddag.map(image))
+        _gaddag.load(dictionary);
+
+    // Without a leave table moves are ranked by their points alone
+    _leaves.map(LEAVES_IMAGE);
+
+    #if (METHOD == PROBABILISTIC)
+        _anagrams.build(_gaddag.words());
+    #endif
+}
+
+/**
+ * Starts the workers if the board is searched with more than one thread.
+ * Only the brute force search is split between threads.
+ */
+void Solver::startThreads(std::size_t threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+
+    #if (METHOD == BRUTE_FORCE)
+        if (threads <= 1) return;
+        _pool.reset(new ThreadPool(threads));
+        for (std::size_t idx = 0; idx < threads; ++idx)
+            _generators.emplace_back(new MoveGenerator(_gaddag, leaves()));
+    #endif
+}
+
+void Solver::enableCache(std::size_t bytes) {
+    _cache.reset(bytes ? new ResultCache(bytes) : nullptr);
+}
+
+Move Solver::findBestWord(Board& board, const std::string& letters, QueryStats* stats) const {
+    STATS(QueryStats counted);
+    STATS(auto query_start = std::chrono::steady_clock::now());
+
+    std::uint64_t key = 0;
+    if (_cache) {
+        key = positionKey(board, letters);
+        Move cached;
+        if (_cache->find(key, cached)) {
+            STATS(if (stats) stats->total_ns += QueryStats::since(query_start));
+            return cached;
+        }
+    }
+
+    if (!board.cross_checks_ready)
+        computeCrossChecks(board, _gaddag);
+    STATS(counted.cross_check_ns = QueryStats::since(query_start));
+
+    #if (METHOD == PROBABILISTIC)
+        Move best_move = ::findBestWord(board, letters, _anagrams, stats);
+    #else
+        Move best_move;
+        if (!_pool) {
+            best_move = ::findBestWord(board, letters, _gaddag, stats, leaves());
+        } else {
+            STATS(auto search_start = std::chrono::steady_clock::now());
+
+            // One task for each row and then each column, in the order they are searched by one thread.
+            // Their results live in the query's scratch.
+            Arena& arena = queryArena();
+            ArenaScope scope(arena);
+            const std::size_t lines = BOARD_SIZE << 1;
+            Move* line_best = arena.allocate<Move>(lines);
+            std::uninitialized_fill(line_best, line_best + lines, Move());
+            STATS(QueryStats* line_stats = arena.allocate<QueryStats>(lines));
+            STATS(std::uninitialized_fill(line_stats, line_stats + lines, QueryStats()));
+            const Board& position = board;
+
+            // Best equity found by any line, so the lines cut off words that can't beat each other's moves
+            std::atomic<double> floor(-std::numeric_limits<double>::infinity());
+            _pool->run(lines, [&](std::size_t task, std::size_t worker) {
+                int direction = (task < BOARD_SIZE) ? HORIZONTAL : VERTICAL;
+                line_best[task] = _generators[worker]->best(position, letters, direction, (int) (task % BOARD_SIZE), &floor);
+                STATS(if (stats) line_stats[task] = _generators[worker]->stats());
+            });
+
+            // Ties go to the line searched first, just like with one thread. A line without a move returns a pass.
+            for (std::size_t idx = 0; idx < lines; ++idx) {
+                const Move& found = line_best[idx];
+                if (!found.word.empty() && (best_move.word.empty() || found.equity() > best_move.equity()))
+                    best_move = found;
+            }
+
+            STATS(if (stats) {
+                for (std::size_t idx = 0; idx < lines; ++idx) counted.add(line_stats[idx]);
+                counted.search_ns = QueryStats::since(search_start);
+            });
+        }
+    #endif
+
+    if (_cache) _cache->insert(key, best_move);
+
+    STATS(if (stats) {
+        counted.total_ns = QueryStats::since(query_start);
+        stats->add(counted);
+    });
+    return best_move;
+}
+
+std::vector<Move> Solver::findTopMoves(Board& board, const std::string& letters, std::size_t k) const {
+    if (!board.cross_checks_ready)
+        computeCrossChecks(board, _gaddag);
+
+    if (!_pool) return ::findTopMoves(board, letters, k, _gaddag, leaves());
+
+    // Every line keeps its own best k moves, the lines are merged in the order they are searched
+    std::vector<TopMoves> line_top(BOARD_SIZE << 1, TopMoves(k));
+    const Board& position = board;
+    _pool->run(line_top.size(), [&](std::size_t task, std::size_t worker) {
+        int direction = (task < BOARD_SIZE) ? HORIZONTAL : VERTICAL;
+        TopMoves& top = line_top[task];
+        _generators[worker]->generate(position, letters, direction, (int) (task % BOARD_SIZE), [&top](const Move& m) {
+            top.offer(m);
+        });
+    });
+
+    TopMoves top(k);
+    for (std::size_t idx = 0; idx < line_top.size(); ++idx) top.merge(line_top[idx]);
+    return top.sorted();
+}
+
+std::vector<std::string> Solver::getPossibleWords(const std::string& letters, std::size_t min_length) const {
+    std::call_once(_lexicon_built, [this]() { _lexicon.build(_gaddag.words()); });
+    return _lexicon.wordsFrom(letters, min_length);
+}
+
+const Solver& defaultSolver() {
+    static Solver solver;
+    return solver;
+}
+
+/**
+ * Finds the best word with the shared solver
+ */
+Move findBestWord(Board& board, std::string letters) {
+    return defaultSolver().findBestWord(board, letters);
+}
+
+/**
+ * Finds the best moves with the shared solver
+ */
+std::vector<Move> findTopMoves(Board& board, std::string letters, std::size_t k) {
+    return defaultSolver().findTopMoves(board, letters, k);
+}
@@ -0,0 +1,170 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "anagram.h"
+#include "board.h"
+#include "cache.h"
+#include "gaddag.h"
+#include "leaves.h"
+#include "lexicon.h"
+#include "movegen.h"
+#include "threadpool.h"
+
+// Threads used to search the board, 0 for one on each core
+#define SOLVER_THREADS 0
+
+/**
+ * A solver loads the Scrabble dictionary and everything derived
+ * from it once, and then answers any number of queries against
+ * that state without touching the dictionary files again.
+ *
+ * Queries don't modify the solver, so one solver can be shared
+ * by every query in the process.
+ *
+ * If the compiled leave table (LEAVES_IMAGE) is there it is loaded too,
+ * and moves are then ranked by their points plus the equity of the tiles
+ * they leave on the rack.
+ *
+ * With a result cache, the best move of a position that was already
+ * solved is returned without searching the board again.
+ *
+ * With more than one thread, the rows and columns of the board are
+ * searched in parallel. The best move of every line is kept apart and
+ * the lines are merged in order, so the move found is the same for
+ * any number of threads.
+ */
+class Solver {
+public:
+    /**
+     * Loads the compiled dictionary image, or the text
+     * dictionary if there is no image
+     * @param threads
+     *          Threads used to search the board, 0 for one on each core
+     */
+    explicit Solver(std::size_t threads = SOLVER_THREADS);
+
+    /**
+     * Loads the dictionary from the given locations
+     * @param image
+     *          Compiled dictionary image, tried first
+     * @param dictionary
+     *          Text dictionary with one word per line
+     * @param threads
+     *          Threads used to search the board, 0 for one on each core
+     */
+    Solver(const std::string& image, const std::string& dictionary, std::size_t threads = SOLVER_THREADS);
+
+    Solver(const Solver&) = delete;
+    Solver& operator=(const Solver&) = delete;
+
+    /**
+     * Keeps the best move of every position solved by findBestWord, up to
+     * the given memory, replacing any results cached so far. Must be called
+     * before the solver is shared between threads.
+     * @param bytes
+     *          Memory cap of the cache, 0 to stop caching
+     */
+    void enableCache(std::size_t bytes);
+
+    /**
+     * Counters of the result cache, all 0 without one
+     */
+    CacheStats cacheStats() const { return _cache ? _cache->stats() : CacheStats(); }
+
+    /**
+     * Whether or not a dictionary was loaded
+     */
+    bool isLoaded() const { return _gaddag.wordCount() > 0; }
+
+    /**
+     * Finds the best word given the current state of the board
+     * and a set of letters that the user has.
+     * The board's cross-checks are computed if they aren't already.
+     * @param board
+     *              State of the Scrabble board
+     * @param letters
+     *              Letters in the hands of the user
+     * @param stats
+     *              Filled in with what the query did and how long each
+     *              part of it took, if not null
+     * @return The move with the most equity given the board status and letters in hand
+     */
+    Move findBestWord(Board& board, const std::string& letters, QueryStats* stats = nullptr) const;
+
+    /**
+     * Finds the k moves with the most points given the current state
+     * of the board and a set of letters that the user has.
+     * Every legal move is generated whatever the search method is.
+     * @param board
+     *              State of the Scrabble board
+     * @param letters
+     *              Letters in the hands of the user
+     * @param k
+     *              Number of moves to return
+     * @return Up to k moves from most to least equity, moves with the
+     *         same equity in the order they are generated
+     */
+    std::vector<Move> findTopMoves(Board& board, const std::string& letters, std::size_t k) const;
+
+    /**
+     * Retrieves all possible words given the combination of letters,
+     * regardless of the board
+     * @param letters
+     *              Letters that can be used to make the words
+     * @param min_length
+     *              Shortest word to return
+     * @return Words that can be made from the letters, shortest first
+     */
+    std::vector<std::string> getPossibleWords(const std::string& letters, std::size_t min_length = 2) const;
+
+    /**
+     * GADDAG of the Scrabble dictionary
+     */
+    const Gaddag& gaddag() const { return _gaddag; }
+
+    /**
+     * Equity of the leaves, null if there is no leave table
+     */
+    const LeaveTable* leaves() const { return _leaves.isLoaded() ? &_leaves : nullptr; }
+
+    /**
+     * Number of threads used to search the board
+     */
+    std::size_t threads() const { return _pool ? _pool->size() : 1; }
+
+private:
+    void load(const std::string& image, const std::string& dictionary);
+    void startThreads(std::size_t threads);
+
+    Gaddag _gaddag;
+    LeaveTable _leaves;
+
+    // Only built the first time words are listed, so startup stays quick
+    mutable Lexicon _lexicon;
+    mutable std::once_flag _lexicon_built;
+
+    #if (METHOD == PROBABILISTIC)
+        // Words in the dictionary by their letters
+        AnagramIndex _anagrams;
+    #endif
+
+    // Best move of the positions already solved, if caching is on
+    std::unique_ptr<ResultCache> _cache;
+
+    // Workers and the move generator each of them uses, only when there is more than one thread
+    std::unique_ptr<ThreadPool> _pool;
+    std::vector<std::unique_ptr<MoveGenerator> > _generators;
+};
+
+/**
+ * Solver shared by the functions that don't take one.
+ * It is created the first time it is needed.
+ */
+const Solver& defaultSolver();
+
+#endif /* SOLVER_H */
@@ -0,0 +1,71 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Determines whether or not the searches count what they do
+ * 0 = Nothing is counted or timed, the counting code is compiled out
+ * 1 = Every query can return its statistics
+ */
+#ifndef QUERY_STATS
+    #define QUERY_STATS 1
+#endif
+
+/**
+ * Wraps a statement that only exists when statistics are kept
+ */
+#if (QUERY_STATS)
+    #define STATS(statement) statement
+#else
+    #define STATS(statement)
+#endif
+
+/**
+ * What a single query did and where its time went.
+ * The counters are only filled in when QUERY_STATS is on.
+ */
+typedef struct QueryStats {
+    std::uint64_t words;          // Complete words found at a place on the board
+    std::uint64_t placements;     // Moves placed and scored
+    std::uint64_t rejected;       // Letters turned away by a cross-check
+    std::uint64_t lookups;        // GADDAG edges followed, or anagram index queries by the probabilistic search
+    std::uint64_t pruned;         // Anchors and partial words cut off because they can't beat the best move
+    std::uint64_t cross_check_ns; // Time spent computing the cross-checks of the board
+    std::uint64_t probability_ns; // Time spent finding the most likely squares (probabilistic search)
+    std::uint64_t search_ns;      // Time spent searching for moves
+    std::uint64_t total_ns;       // Time spent on the whole query
+
+    /**
+     * QueryStats default constructor
+     * Defaults: Everything is 0
+     */
+    QueryStats() : words(0), placements(0), rejected(0), lookups(0), pruned(0),
+        cross_check_ns(0), probability_ns(0), search_ns(0), total_ns(0) {};
+
+    /**
+     * Adds the counters and times of another query
+     */
+    void add(const QueryStats& other) {
+        words += other.words;
+        placements += other.placements;
+        rejected += other.rejected;
+        lookups += other.lookups;
+        pruned += other.pruned;
+        cross_check_ns += other.cross_check_ns;
+        probability_ns += other.probability_ns;
+        search_ns += other.search_ns;
+        total_ns += other.total_ns;
+    }
+
+    /**
+     * Nanoseconds since the given time, for timing a phase
+     */
+    static std::uint64_t since(std::chrono::steady_clock::time_point start) {
+        return (std::uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+} query_stats;
+
+#endif /* STATS_H */
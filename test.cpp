@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -5,14 +7,251 @@
 #include <vector>
 
 #include "board.h"
+#include "endgame.h"
+#include "game.h"
+#include "leaves.h"
+#include "movegen.h"
+#include "simulate.h"
+#include "solver.h"
+
+// Positions the checks are run on unless given on the command line, relative to the build directory
+#define TEST_POSITIONS "../bench/positions.txt"
+
+/**
+ * Number of checks that failed, the program fails if there are any
+ */
+static int failures = 0;
+
+/**
+ * Reports a check that failed
+ */
+void check(bool passed, const std::string& what) {
+    if (passed) return;
+    ++failures;
+    std::cout << "FAILED: " << what << "\n";
+}
+
+/**
+ * Whether or not two moves place the same word at the same place
+ */
+bool sameMove(const Move& a, const Move& b) {
+    return a.word == b.word && a.anchorX == b.anchorX && a.anchorY == b.anchorY &&
+           a.direction == b.direction && a.points == b.points;
+}
+
+/**
+ * Best move found by looking at every legal move: the first one
+ * generated with the most equity, any legal move rather than a pass
+ */
+Move bestGenerated(MoveGenerator& generator, const Board& board, const std::string& letters) {
+    Move best;
+    generator.generate(board, letters, [&best](const Move& m) {
+        if (best.word.empty() || m.equity() > best.equity()) best = m;
+    });
+    return best;
+}
+
+/**
+ * Whether or not two boards hold the same tiles with the same hash and cross-checks
+ */
+bool sameBoard(const Board& a, const Board& b) {
+    return std::equal(a.letters, a.letters + BOARD_AREA, b.letters) &&
+           std::equal(a.transposed, a.transposed + BOARD_AREA, b.transposed) &&
+           a.occupied == b.occupied && a.occupied_transposed == b.occupied_transposed && a.blanks == b.blanks &&
+           a.hash == b.hash && a.history.size() == b.history.size() &&
+           std::equal(a.cross_checks[0], a.cross_checks[0] + 2 * BOARD_AREA, b.cross_checks[0]) &&
+           std::equal(a.cross_points[0], a.cross_points[0] + 2 * BOARD_AREA, b.cross_points[0]);
+}
+
+/**
+ * Plays the best move of the rack a few times in a row, checking that
+ * the hash and the cross-checks kept up to date by "apply" match the
+ * ones computed from scratch, and that "undo" gives back the position
+ */
+void checkApplyUndo(const Solver& solver, const Board& position, const std::string& rack, const std::string& name) {
+    Board board = position;
+    int applied = 0;
+    for (; applied < 3; ++applied) {
+        Move move = solver.findBestWord(board, rack);
+        if (move.word.empty()) break;
+        check(board.apply(move), name + ": apply " + move.word.str());
+        check(board.hash == board.computeHash(), name + ": hash after " + move.word.str());
+
+        Board computed = board;
+        computed.cross_checks_ready = false;
+        computeCrossChecks(computed, solver.gaddag());
+        check(sameBoard(board, computed), name + ": cross-checks after " + move.word.str());
+    }
+    for (; applied > 0; --applied) check(board.undo(), name + ": undo");
+    check(!board.undo(), name + ": nothing left to undo");
+    check(sameBoard(board, position), name + ": position after undo");
+}
+
+/**
+ * Checks that the best move is the one a search of every move keeps
+ */
+void checkBest(MoveGenerator& generator, const Board& board, const std::string& rack, const std::string& name) {
+    Move wanted = bestGenerated(generator, board, rack);
+    Move found = generator.best(board, rack);
+    check(sameMove(found, wanted), name + ": best move of " + rack + " is \"" + found.word.str() +
+          "\" instead of \"" + wanted.word.str() + "\"");
+}
+
+/**
+ * Checks that the enumerator hands out the moves generate finds, in the same order
+ */
+void checkEnumerator(const Solver& solver, const Board& board, const std::string& rack,
+                     const MoveFilter& filter, const std::string& name) {
+    std::vector<Move> wanted;
+    MoveGenerator generator(solver.gaddag(), solver.leaves());
+    generator.generate(board, rack, [&](const Move& m) {
+        std::size_t square = (std::size_t) filter.square;
+        std::size_t first = (std::size_t) (m.anchorY * BOARD_SIZE + m.anchorX);
+        std::size_t step = (m.direction == HORIZONTAL) ? 1 : BOARD_SIZE;
+        bool covers = filter.square < 0 || (square >= first && square <= first + step * (m.word.length() - 1) &&
+                                             (square - first) % step == 0);
+        if (m.points >= filter.min_points && covers && (int) m.word.length() >= filter.min_length &&
+            (int) m.word.length() <= filter.max_length)
+            wanted.push_back(m);
+    });
+
+    MoveEnumerator moves(solver.gaddag(), board, rack, filter, solver.leaves());
+    std::size_t taken = 0;
+    Move pulled;
+    bool same = true;
+    while (moves.next(pulled)) same = same && taken < wanted.size() && sameMove(pulled, wanted[taken++]);
+    check(same && taken == wanted.size(), name + ": enumerated moves of " + rack);
+}
+
+/**
+ * Checks that the searches of the solver agree with each other: with one
+ * thread and with several, from the cache, and with the top moves
+ */
+void checkSolvers(const Solver& single, const Solver& threaded, const Solver& cached,
+                  const Board& position, const std::string& rack, const std::string& name) {
+    Board board = position;
+    Move best = single.findBestWord(board, rack);
+    board = position;
+    check(sameMove(threaded.findBestWord(board, rack), best), name + ": best move with threads");
+
+    for (int query = 0; query < 2; ++query) {
+        board = position;
+        check(sameMove(cached.findBestWord(board, rack), best), name + ": best move from the cache");
+    }
+
+    board = position;
+    std::vector<Move> top = single.findTopMoves(board, rack, 10);
+    // The probabilistic search doesn't look at every move, so only the brute force one finds the first of them
+    #if (METHOD == BRUTE_FORCE)
+        check(top.empty() ? best.word.empty() : sameMove(top[0], best), name + ": first of the top moves");
+    #endif
+    for (std::size_t idx = 1; idx < top.size(); ++idx)
+        check(top[idx].equity() <= top[idx - 1].equity(), name + ": order of the top moves");
+
+    board = position;
+    std::vector<Move> threaded_top = threaded.findTopMoves(board, rack, 10);
+    bool same = threaded_top.size() == top.size();
+    for (std::size_t idx = 0; same && idx < top.size(); ++idx) same = sameMove(threaded_top[idx], top[idx]);
+    check(same, name + ": top moves with threads");
+}
+
+/**
+ * Plays out an endgame line and works out its spread for the side to move
+ * @return Whether or not every move could be played and the line ends the game
+ */
+bool playLine(Board board, const std::string& rack, const std::string& opponent,
+              const std::vector<Move>& line, int& spread) {
+    std::string racks[2] = {rack, opponent};
+    spread = 0;
+    bool passed = false;
+    for (std::size_t ply = 0; ply < line.size(); ++ply) {
+        int side = ply & 1, sign = side ? -1 : 1;
+        std::string& tiles = racks[side];
+        if (line[ply].word.empty()) {
+            // Two passes in a row end the game, each side loses what is left on its rack
+            if (passed) {
+                spread += sign * (rackPoints(racks[side ^ 1]) - rackPoints(tiles));
+                return ply + 1 == line.size();
+            }
+            passed = true;
+            continue;
+        }
+        passed = false;
+
+        for (char tile : tilesPlaced(board, line[ply])) {
+            std::size_t at = tiles.find(tile);
+            if (at == std::string::npos) return false;
+            tiles.erase(at, 1);
+        }
+        if (!board.apply(line[ply])) return false;
+        spread += sign * (int) line[ply].points;
+
+        // Going out gains twice what is left on the other rack
+        if (tiles.empty()) {
+            spread += sign * 2 * rackPoints(racks[side ^ 1]);
+            return ply + 1 == line.size();
+        }
+    }
+    return false;
+}
+
+/**
+ * Checks that the endgame line found with the transposition table is as
+ * long as the one found without it, and that both play out to their spread
+ */
+void checkEndgame(const Solver& solver, const Board& position, const std::string& rack,
+                  const std::string& opponent, const std::string& name) {
+    EndgameSolver with_table(solver), without_table(solver, 0);
+    Board board = position;
+    EndgameResult found = with_table.solve(board, rack, opponent, 0);
+    board = position;
+    EndgameResult wanted = without_table.solve(board, rack, opponent, 0);
+
+    check(found.solved && wanted.solved && found.spread == wanted.spread, name + ": endgame spread");
+    check(found.line.size() == wanted.line.size(), name + ": endgame line of " + std::to_string(found.line.size()) +
+          " moves instead of " + std::to_string(wanted.line.size()));
+
+    int spread = 0;
+    check(playLine(position, rack, opponent, found.line, spread) && spread == found.spread,
+          name + ": endgame line plays out to its spread");
+}
+
+/**
+ * Checks that a damaged dictionary image is turned down and leaves the
+ * GADDAG that was mapped before it in place
+ */
+void checkImage(const Gaddag& gaddag) {
+    const std::string filename = "checks.gaddag";
+    check(gaddag.save(filename), "dictionary image written");
+    Gaddag mapped;
+    check(mapped.map(filename), "dictionary image mapped");
+
+    // Point the first edge past the end of the node array
+    std::fstream image(filename, std::ios::in | std::ios::out | std::ios::binary);
+    image.seekp(sizeof(Gaddag::ImageHeader) + gaddag.nodeCount() * sizeof(Gaddag::Node));
+    Gaddag::node_t child = (Gaddag::node_t) gaddag.nodeCount();
+    image.write(reinterpret_cast<const char*>(&child), sizeof(child));
+    image.close();
+
+    check(!mapped.map(filename), "damaged dictionary image turned down");
+    check(mapped.contains("QUARTZ"), "dictionary kept after a damaged image");
+    std::remove(filename.c_str());
+}
+
+/**
+ * Runs the examples and then the checks: test [POSITIONS]
+ * Fails if any check does.
+ */
+int main(int argc, char* argv[]) {
+    // Dictionary is loaded once and used for every query
+    Solver solver;
 
-int main() {
     /**
      * Testing methods with an empty board
      */
     std::cout << "------------------------EMPTY-----------------------------\n\n";
     Board b_empty = createBoardFromFile("tests/empty.txt");
-    Move best = findBestWord(b_empty, "DGENEAE");
+    Move best = solver.findBestWord(b_empty, "DGENEAE");
     best.print();
 
     /**
@@ -21,8 +260,28 @@ int main() {
     std::cout << "------------------------FULL------------------------------\n\n";
     //Board b_full = createBoardFromFile("tests/test.txt");
     Board b_mom = createBoardFromFile("tests/mom.txt");
-    Move best_move = findBestWord(b_mom, "ERDACIA");
+    QueryStats stats;
+    Move best_move = solver.findBestWord(b_mom, "ERDACIA", &stats);
     best_move.print();
+    std::cout << "Words: " << stats.words << ", placements: " << stats.placements
+              << ", rejected: " << stats.rejected << ", lookups: " << stats.lookups << ", pruned: " << stats.pruned
+              << ", search: " << stats.search_ns / 1000 << " us, total: " << stats.total_ns / 1000 << " us\n";
+
+    // Runner-up moves, the first one is the best move
+    std::vector<Move> top_moves = solver.findTopMoves(b_mom, "ERDACIA", 5);
+    for (Move& m : top_moves) m.print();
+
+    // Moves pulled one at a time, stopping after the first three through the middle square worth 20 points
+    MoveFilter filter;
+    filter.min_points = 20;
+    filter.square = (BOARD_SIZE >> 1) * BOARD_SIZE + (BOARD_SIZE >> 1);
+    MoveEnumerator moves(solver.gaddag(), b_mom, "ERDACIA", filter, solver.leaves());
+    Move pulled;
+    for (int count = 0; count < 3 && moves.next(pulled); ++count) pulled.print();
+
+    // A blank ('?') is played as a lowercase letter worth no points
+    Move blank_move = solver.findBestWord(b_mom, "ERDAC?A");
+    blank_move.print();
     // printBoardValues(b_full);
 
     // std::cout << getEmptyNeighbors(b_full, b_full.tiles[4][3]) << std::endl;
@@ -67,9 +326,56 @@ int main() {
      * Testing certain methods
      */
     std::cout << "--------------------METHOD TESTING------------------------\n\n";
+
     // char queen[5] = {'Q', 'U', 'E', 'E', 'N'};
     // std::string like = "Like";
     // std::cout << like.find('e', 4) << ", " << std::string::npos << std::endl;
 
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+    /**
+     * Checks of the results, the program fails if one of them is wrong
+     */
+    std::cout << "------------------------CHECKS----------------------------\n\n";
+    checkImage(solver.gaddag());
+
+    std::vector<Board> positions;
+    std::vector<std::string> racks;
+    std::string corpus_file = (argc >= 2) ? argv[1] : TEST_POSITIONS;
+    std::ifstream corpus(corpus_file);
+    Board position;
+    std::string rack;
+    while (readPosition(corpus, position, rack)) {
+        computeCrossChecks(position, solver.gaddag());
+        positions.push_back(position);
+        racks.push_back(rack);
+    }
+    check(!positions.empty(), "positions read from " + corpus_file);
+
+    Solver single(1), threaded(4), cached(1);
+    cached.enableCache(1 << 20);
+
+    // Moves are ranked by points alone, and by equity with leaves
+    LeaveTable estimates;
+    estimates.estimate();
+    MoveGenerator plain(solver.gaddag()), valued(solver.gaddag(), &estimates);
+
+    for (std::size_t idx = 0; idx < positions.size(); ++idx) {
+        std::string name = "position " + std::to_string(idx);
+        checkApplyUndo(solver, positions[idx], racks[idx], name);
+        checkBest(plain, positions[idx], racks[idx], name);
+        checkBest(valued, positions[idx], racks[idx], name + " with leaves");
+        checkEnumerator(solver, positions[idx], racks[idx], MoveFilter(), name);
+        checkEnumerator(solver, positions[idx], racks[idx], filter, name + " through the middle square");
+        checkSolvers(single, threaded, cached, positions[idx], racks[idx], name);
+
+        // Racks whose leaves cost more than any of their moves score still play a move
+        checkBest(valued, positions[idx], "QIIIUUV", name + " with leaves");
+        checkBest(valued, positions[idx], "IIUUVVW", name + " with leaves");
+
+        // Endgames of a few tiles each, searched to the end with and without the table
+        if (positions[idx].occupied.count() >= 60)
+            checkEndgame(solver, positions[idx], racks[idx].substr(0, 3), racks[idx].substr(racks[idx].size() - 3), name);
+    }
+
+    std::cout << failures << " checks failed\n";
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(std::size_t threads) : _pending(0), _stopping(false) {
+    if (threads == 0) threads = 1;
+
+    for (std::size_t idx = 0; idx < threads; ++idx)
+        _queues.emplace_back(new Queue());
+    for (std::size_t idx = 0; idx < threads; ++idx)
+        _threads.emplace_back(&ThreadPool::work, this, idx);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(_sleep_lock);
+        _stopping = true;
+    }
+    _wake.notify_all();
+    for (std::size_t idx = 0; idx < _threads.size(); ++idx)
+        _threads[idx].join();
+}
+
+/**
+ * Deals the tasks out over the queues in contiguous blocks, so each
+ * worker starts on neighbouring tasks, then waits for the batch
+ */
+void ThreadPool::run(std::size_t count, const Task& task) {
+    if (count == 0) return;
+
+    Batch current;
+    current.task = &task;
+    current.remaining = count;
+
+    // Counted first so a worker that takes a task early never sees a negative count
+    {
+        std::lock_guard<std::mutex> guard(_sleep_lock);
+        _pending += count;
+    }
+
+    std::size_t workers = _queues.size();
+    for (std::size_t worker = 0; worker < workers; ++worker) {
+        std::size_t first = count * worker / workers, last = count * (worker + 1) / workers;
+        if (first == last) continue;
+
+        std::lock_guard<std::mutex> guard(_queues[worker]->lock);
+        for (std::size_t idx = first; idx < last; ++idx)
+            _queues[worker]->jobs.push_back(Job{&current, idx});
+    }
+
+    _wake.notify_all();
+
+    std::unique_lock<std::mutex> guard(current.lock);
+    current.done.wait(guard, [&current]() { return current.remaining == 0; });
+}
+
+/**
+ * Runs tasks from the worker's own queue, then from the others,
+ * and sleeps when there is nothing left anywhere
+ */
+void ThreadPool::work(std::size_t worker) {
+    for (;;) {
+        Job job;
+        if (pop(worker, job) || steal(worker, job)) {
+            --_pending;
+            (*job.batch->task)(job.index, worker);
+
+            std::lock_guard<std::mutex> guard(job.batch->lock);
+            if (--job.batch->remaining == 0)
+                job.batch->done.notify_all();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(_sleep_lock);
+        _wake.wait(guard, [this]() { return _pending > 0 || _stopping; });
+        if (_pending == 0 && _stopping) return;
+    }
+}
+
+/**
+ * Takes the most recently queued task of the worker's own queue
+ */
+bool ThreadPool::pop(std::size_t worker, Job& job) {
+    Queue& own = *_queues[worker];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if (own.jobs.empty()) return false;
+    job = own.jobs.back();
+    own.jobs.pop_back();
+    return true;
+}
+
+/**
+ * Takes the oldest task of another worker's queue
+ */
+bool ThreadPool::steal(std::size_t worker, Job& job) {
+    std::size_t workers = _queues.size();
+    for (std::size_t offset = 1; offset < workers; ++offset) {
+        Queue& other = *_queues[(worker + offset) % workers];
+        std::lock_guard<std::mutex> guard(other.lock);
+        if (other.jobs.empty()) continue;
+        job = other.jobs.front();
+        other.jobs.pop_front();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,95 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads that run batches of numbered tasks.
+ *
+ * Every worker has its own queue. The tasks of a batch are dealt out
+ * over the queues, each worker takes tasks from the back of its own
+ * queue and, once it runs out, steals from the front of the others,
+ * so a worker that drew quick tasks helps with the slow ones.
+ *
+ * A worker only ever runs one task at a time, so state indexed by
+ * the worker number can be used by a task without locking. Several
+ * threads may run batches on the same pool at once.
+ */
+class ThreadPool {
+public:
+    /**
+     * Called with the number of the task (0 to count - 1) and the
+     * number of the worker running it (0 to size() - 1)
+     */
+    typedef std::function<void(std::size_t task, std::size_t worker)> Task;
+
+    /**
+     * Starts the worker threads
+     * @param threads
+     *          Number of workers, at least one is always started
+     */
+    explicit ThreadPool(std::size_t threads);
+
+    /**
+     * Stops the workers once every queued task has run
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Number of worker threads
+     */
+    std::size_t size() const { return _threads.size(); }
+
+    /**
+     * Runs a batch of tasks and waits until all of them are done
+     * @param count
+     *          Number of tasks in the batch
+     * @param task
+     *          Called once for each task number
+     */
+    void run(std::size_t count, const Task& task);
+
+private:
+    typedef struct Batch {
+        const Task* task;
+        std::size_t remaining;
+        std::mutex lock;
+        std::condition_variable done;
+    } batch;
+
+    typedef struct Job {
+        Batch* batch;
+        std::size_t index;
+    } job;
+
+    typedef struct Queue {
+        std::mutex lock;
+        std::deque<Job> jobs;
+    } queue;
+
+    void work(std::size_t worker);
+    bool pop(std::size_t worker, Job& job);
+    bool steal(std::size_t worker, Job& job);
+
+    std::vector<std::unique_ptr<Queue> > _queues;
+    std::vector<std::thread> _threads;
+
+    // Workers sleep here while every queue is empty
+    std::mutex _sleep_lock;
+    std::condition_variable _wake;
+    std::atomic<std::size_t> _pending;
+    bool _stopping;
+};
+
+#endif /* THREADPOOL_H */